@@ -0,0 +1,492 @@
+#include "network_generator.h"
+
+#include "input_reader.h"
+#include "json.h"
+#include "json_builder.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "router.h"
+#include "serialization.h"
+#include "stats.h"
+#include "svg.h"
+#include "thread_pool.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Бенчмарки этапов make_base и process_requests на синтетической сети.
+// Аргумент бенчмарка — число остановок, остальные параметры сети выводятся из него.
+// Результаты для сравнения между сборками сохраняются в JSON:
+//     ./benchmarks --benchmark_out=result.json --benchmark_out_format=json
+
+namespace {
+
+using namespace std::literals;
+using namespace transport_catalogue;
+
+const std::string& GetDataBasePath() {
+    static const std::string path = (std::filesystem::temp_directory_path() / "transport_catalogue_benchmark.db").string();
+    return path;
+}
+
+const std::filesystem::path& GetTextBasePath() {
+    static const std::filesystem::path path = std::filesystem::temp_directory_path() / "transport_catalogue_benchmark.txt";
+    return path;
+}
+
+benchmarks::NetworkParams MakeParams(size_t stops_count) {
+    benchmarks::NetworkParams params;
+    params.stops_count = stops_count;
+    params.buses_count = std::max<size_t>(stops_count / 5, 1);
+    params.route_length = 10;
+    params.distance_density = 1.0;
+    return params;
+}
+
+// Сеть заданного размера, построенная один раз на все бенчмарки
+struct Network {
+    explicit Network(size_t stops_count)
+        : params(MakeParams(stops_count))
+        , base_document(benchmarks::GenerateBaseDocument(params, GetDataBasePath()))
+        , reader(base_document)
+        , router(db) {
+        std::ostringstream out;
+        json::Print(base_document, out);
+        base_text = out.str();
+        text_base_text = benchmarks::ConvertToText(base_document);
+
+        reader.UpdateTransportCatalogue(db);
+        reader.UpdateMapRenderer(renderer);
+        reader.UpdateRouter(router);
+        router.BuildGraph(db);
+    }
+
+    benchmarks::NetworkParams params;
+    json::Document base_document;
+    std::string base_text;
+    // Те же запросы base_requests в текстовом формате input_reader
+    std::string text_base_text;
+    JsonReader reader;
+    TransportCatalogue db;
+    renderer::MapRenderer renderer;
+    router::Router router;
+};
+
+Network& GetNetwork(size_t stops_count) {
+    static std::map<size_t, std::unique_ptr<Network>> networks;
+    auto& network = networks[stops_count];
+    if (!network) {
+        network = std::make_unique<Network>(stops_count);
+    }
+    return *network;
+}
+
+void SetNetworkCounters(benchmark::State& state, const Network& network) {
+    state.counters["stops"] = static_cast<double>(network.params.stops_count);
+    state.counters["buses"] = static_cast<double>(network.params.buses_count);
+}
+
+void BM_JsonLoad(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        std::istringstream input(network.base_text);
+        benchmark::DoNotOptimize(json::Load(input));
+    }
+    state.SetBytesProcessed(state.iterations() * network.base_text.size());
+    SetNetworkCounters(state, network);
+}
+
+void BM_UpdateTransportCatalogue(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        TransportCatalogue db;
+        network.reader.UpdateTransportCatalogue(db);
+        benchmark::DoNotOptimize(db);
+    }
+    SetNetworkCounters(state, network);
+}
+
+// Прежний разбор текстового формата: построчное чтение из потока с копированием строк
+void BM_TextUpdateTransportCatalogue(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        std::istringstream input(network.text_base_text);
+        TransportCatalogue db;
+        input_queries_utils::UpdateTransportCatalogue(db, input);
+        benchmark::DoNotOptimize(db);
+    }
+    state.SetBytesProcessed(state.iterations() * network.text_base_text.size());
+    SetNetworkCounters(state, network);
+}
+
+// Однопроходный разбор того же текста из файла, отображённого в память
+void BM_TextLoadTransportCatalogue(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    std::ofstream(GetTextBasePath(), std::ios::binary) << network.text_base_text;
+    for (auto _ : state) {
+        TransportCatalogue db;
+        input_queries_utils::LoadTransportCatalogue(db, GetTextBasePath());
+        benchmark::DoNotOptimize(db);
+    }
+    state.SetBytesProcessed(state.iterations() * network.text_base_text.size());
+    SetNetworkCounters(state, network);
+}
+
+void BM_BuildGraph(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        router::Router router(network.db);
+        router.SetRoutingSettings(network.router.GetRoutingSettings());
+        router.BuildGraph(network.db);
+        benchmark::DoNotOptimize(router.GetGraph());
+    }
+    SetNetworkCounters(state, network);
+    state.counters["edges"] = static_cast<double>(network.router.GetGraph().GetEdgeCount());
+}
+
+// Конструктор graph::Router считает кратчайшие пути между всеми парами вершин за O(V^3),
+// поэтому сети для него берутся небольшие
+void BM_GraphRouterConstruct(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        graph::Router<double> router(network.router.GetGraph());
+        benchmark::DoNotOptimize(router);
+    }
+    SetNetworkCounters(state, network);
+    state.counters["vertices"] = static_cast<double>(network.router.GetGraph().GetVertexCount());
+}
+
+void BM_BuildRoute(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    graph::Router<double> router(network.router.GetGraph());
+    const auto& stop_ids = network.router.GetStopIds();
+    const size_t stops_count = network.params.stops_count;
+
+    size_t i = 0;
+    for (auto _ : state) {
+        // Пары остановок перебираются детерминированно, чтобы прогоны были сравнимы
+        const auto from = stop_ids.at(benchmarks::GetStopName(i % stops_count));
+        const auto to = stop_ids.at(benchmarks::GetStopName((i * 7 + 3) % stops_count));
+        benchmark::DoNotOptimize(router.BuildRoute(from, to));
+        ++i;
+    }
+    SetNetworkCounters(state, network);
+}
+
+void BM_GetSvgDocument(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        svg::Document document = network.renderer.GetSvgDocument(network.db.GetAllBuses());
+        std::ostringstream out;
+        document.Render(out);
+        benchmark::DoNotOptimize(out.str());
+    }
+    SetNetworkCounters(state, network);
+}
+
+// Вывод готовой карты: state.range(1) == 0 — числа выводятся потоком,
+// иначе — через std::to_chars. Текст карты в обоих случаях одинаков
+void BM_RenderSvgDocument(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    svg::Document document = network.renderer.GetSvgDocument(network.db.GetAllBuses());
+    document.SetNumberFormat(state.range(1) == 0 ? svg::NumberFormat::Stream : svg::NumberFormat::ToChars);
+
+    size_t svg_size = 0;
+    for (auto _ : state) {
+        std::ostringstream out;
+        document.Render(out);
+        svg_size = static_cast<size_t>(out.tellp());
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * svg_size);
+    SetNetworkCounters(state, network);
+}
+
+// Построение и вывод карты без упрощения (state.range(1) == 0) и в режиме
+// level_of_detail; счётчик svg_kb — размер карты
+void BM_MapLevelOfDetail(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    renderer::RenderSettings settings = network.renderer.GetRenderSettings();
+    settings.level_of_detail = state.range(1) != 0;
+    renderer::MapRenderer renderer;
+    renderer.SetRenderSettings(std::move(settings));
+
+    size_t svg_size = 0;
+    for (auto _ : state) {
+        std::ostringstream out;
+        renderer.GetSvgDocument(network.db.GetAllBuses()).Render(out);
+        svg_size = static_cast<size_t>(out.tellp());
+        benchmark::DoNotOptimize(out);
+    }
+    state.counters["svg_kb"] = static_cast<double>(svg_size) / 1024;
+    SetNetworkCounters(state, network);
+}
+
+// Построение и вывод карты: state.range(1) == 0 — последовательно, иначе —
+// MapRenderer::RenderMap с пулом из state.range(1) потоков. Результат сверяется
+// с последовательным выводом
+void BM_RenderMap(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    const size_t threads_count = static_cast<size_t>(state.range(1));
+    std::ostringstream expected;
+    network.renderer.GetSvgDocument(network.db.GetAllBuses()).Render(expected);
+
+    std::unique_ptr<thread_pool::ThreadPool> pool;
+    if (threads_count > 0) {
+        pool = std::make_unique<thread_pool::ThreadPool>(threads_count);
+    }
+    std::string svg;
+    for (auto _ : state) {
+        std::ostringstream out;
+        if (pool) {
+            network.renderer.RenderMap(network.db.GetAllBuses(), out, *pool);
+        } else {
+            network.renderer.GetSvgDocument(network.db.GetAllBuses()).Render(out);
+        }
+        svg = out.str();
+        benchmark::DoNotOptimize(svg);
+    }
+    SetNetworkCounters(state, network);
+    if (svg != expected.str()) {
+        state.SkipWithError("parallel map differs from sequential");
+    }
+}
+
+// Задание и вывод state.range(0) надписей, как у карты: подложка и сама надпись
+// с одним текстом. Каждое десятое название содержит специальные символы XML
+void BM_SvgLabels(benchmark::State& state) {
+    const size_t labels_count = static_cast<size_t>(state.range(0));
+    std::vector<std::string> names;
+    names.reserve(labels_count);
+    for (size_t i = 0; i < labels_count; ++i) {
+        names.push_back(i % 10 == 0 ? "Stop \"Mill & Sons\" <"s + std::to_string(i) + ">"s
+                                    : "Stop number "s + std::to_string(i));
+    }
+
+    for (auto _ : state) {
+        svg::Document document;
+        for (const std::string& name : names) {
+            svg::Text text;
+            text.SetFontFamily("Verdana"s);
+            text.SetData(name);
+            svg::Text underlayer = text;
+            underlayer.SetStrokeWidth(3.0);
+            document.Add(std::move(underlayer));
+            document.Add(std::move(text));
+        }
+        std::ostringstream out;
+        document.Render(out);
+        benchmark::DoNotOptimize(out.str());
+    }
+    state.SetItemsProcessed(state.iterations() * labels_count);
+}
+
+void BM_SerializationRoundTrip(benchmark::State& state) {
+    Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        serialization::Serialization(network.db, network.renderer, network.router, GetDataBasePath()).SerializeDataBase();
+
+        TransportCatalogue restored_db;
+        renderer::MapRenderer restored_renderer;
+        router::Router restored_router(restored_db);
+        serialization::Serialization(restored_db, restored_renderer, restored_router, GetDataBasePath()).DeserializeDataBase();
+        // Граф восстанавливается при первом обращении к нему
+        benchmark::DoNotOptimize(restored_router.GetGraph());
+        benchmark::DoNotOptimize(restored_db);
+    }
+    state.counters["file_size"] = static_cast<double>(std::filesystem::file_size(GetDataBasePath()));
+    SetNetworkCounters(state, network);
+}
+
+// Режим make_base целиком: разбор входного JSON, построение базы, графа и запись в файл
+void BM_MakeBase(benchmark::State& state) {
+    const Network& network = GetNetwork(state.range(0));
+    for (auto _ : state) {
+        std::istringstream input(network.base_text);
+        JsonReader reader(json::Load(input));
+        TransportCatalogue db;
+        renderer::MapRenderer renderer;
+        router::Router router(db);
+        reader.UpdateTransportCatalogue(db);
+        reader.UpdateMapRenderer(renderer);
+        reader.UpdateRouter(router);
+        router.BuildGraph(db);
+        serialization::Serialization(db, renderer, router, GetDataBasePath()).SerializeDataBase();
+    }
+    SetNetworkCounters(state, network);
+}
+
+// Режим process_requests целиком: чтение базы и ответы на запросы (таблица маршрутов
+// строится при первом запросе Route)
+void BM_ProcessRequests(benchmark::State& state) {
+    Network& network = GetNetwork(state.range(0));
+    serialization::Serialization(network.db, network.renderer, network.router, GetDataBasePath()).SerializeDataBase();
+
+    const size_t requests_count = network.params.stops_count;
+    const JsonReader reader(benchmarks::GenerateStatDocument(network.params, GetDataBasePath(), requests_count));
+    for (auto _ : state) {
+        TransportCatalogue restored_db;
+        renderer::MapRenderer restored_renderer;
+        router::Router restored_router(restored_db);
+        serialization::Serialization(restored_db, restored_renderer, restored_router, GetDataBasePath()).DeserializeDataBase();
+
+        RequestHandler handler(restored_db, restored_renderer, restored_router);
+        std::ostringstream out;
+        json::Print(json::Document{reader.ProcessStatRequests(handler)}, out);
+        benchmark::DoNotOptimize(out.str());
+    }
+    state.SetItemsProcessed(state.iterations() * (requests_count + 1));
+    SetNetworkCounters(state, network);
+}
+
+// Запросы Bus и Stop, ответы на которые сохранены в базе, и запросы с неизвестными
+// названиями обрабатываются без выделений памяти: счётчик allocations_per_request
+// должен быть равен нулю, иначе бенчмарк завершается ошибкой
+void BM_StatRequestDispatch(benchmark::State& state) {
+    Network& network = GetNetwork(state.range(0));
+    serialization::Serialization(network.db, network.renderer, network.router, GetDataBasePath()).SerializeDataBase();
+
+    TransportCatalogue restored_db;
+    renderer::MapRenderer restored_renderer;
+    router::Router restored_router(restored_db);
+    serialization::Serialization(restored_db, restored_renderer, restored_router, GetDataBasePath()).DeserializeDataBase();
+    RequestHandler handler(restored_db, restored_renderer, restored_router);
+
+    const json::Document stat_document = benchmarks::GenerateStatDocument(network.params, GetDataBasePath(),
+                                                                          network.params.stops_count);
+    const JsonReader reader(stat_document);
+    std::vector<const json::Dict*> requests;
+    for (const auto& node : stat_document.GetRoot().AsDict().at("stat_requests"s).AsArray()) {
+        const json::Dict& request = node.AsDict();
+        const std::string& type = request.at("type"s).AsString();
+        if (type == "Bus"s || type == "Stop"s) {
+            requests.push_back(&request);
+        }
+    }
+    // Индексы за пределами сети дают названия, которых нет в базе
+    const json::Dict unknown_requests[] = {
+        {{"id"s, 0}, {"type"s, "Bus"s}, {"name"s, benchmarks::GetBusName(network.params.buses_count)}},
+        {{"id"s, 0}, {"type"s, "Stop"s}, {"name"s, benchmarks::GetStopName(network.params.stops_count)}},
+    };
+    for (const json::Dict& request : unknown_requests) {
+        requests.push_back(&request);
+    }
+
+    // Первый проход заполняет гистограммы статистики запросов и не учитывается
+    stats::Enable();
+    for (const json::Dict* request : requests) {
+        benchmark::DoNotOptimize(reader.ProcessStatRequest(*request, handler));
+    }
+
+    size_t allocations = 0;
+    size_t processed = 0;
+    for (auto _ : state) {
+        for (const json::Dict* request : requests) {
+            const size_t allocation_count = stats::GetAllocationCount();
+            json::Node response = reader.ProcessStatRequest(*request, handler);
+            allocations += stats::GetAllocationCount() - allocation_count;
+            benchmark::DoNotOptimize(response);
+        }
+        processed += requests.size();
+    }
+    stats::Disable();
+
+    state.SetItemsProcessed(processed);
+    state.counters["allocations_per_request"] = processed == 0 ? 0.0 : static_cast<double>(allocations) / processed;
+    SetNetworkCounters(state, network);
+    if (allocations != 0) {
+        state.SkipWithError("Bus/Stop request dispatch allocates memory");
+    }
+}
+
+// Ответ на запрос Map: сколько байт выделяется на байт SVG. Помимо роста буфера
+// ostringstream и копии строки из него, ответ не должен копировать карту
+void BM_MapRequestDispatch(benchmark::State& state) {
+    Network& network = GetNetwork(state.range(0));
+    RequestHandler handler(network.db, network.renderer, network.router);
+    const json::Document stat_document(json::Dict{{"stat_requests"s, json::Array{}}});
+    const JsonReader reader(stat_document);
+    const json::Dict request{{"id"s, 1}, {"type"s, "Map"s}};
+
+    size_t svg_size = 0;
+    size_t allocated_bytes = 0;
+    size_t processed = 0;
+    stats::Enable();
+    for (auto _ : state) {
+        const size_t allocated = stats::GetAllocatedBytes();
+        json::Node response = reader.ProcessStatRequest(request, handler);
+        allocated_bytes += stats::GetAllocatedBytes() - allocated;
+        svg_size = response.AsDict().at("map"s).AsString().size();
+        benchmark::DoNotOptimize(response);
+        ++processed;
+    }
+    stats::Disable();
+
+    state.counters["svg_kb"] = static_cast<double>(svg_size) / 1024;
+    state.counters["allocated_per_svg_byte"] = svg_size == 0 || processed == 0
+                                               ? 0.0 : static_cast<double>(allocated_bytes) / processed / svg_size;
+    SetNetworkCounters(state, network);
+}
+
+// Построение массива из state.range(0) словарей через json::Builder: при переносе
+// значений и Build() && число выделений на элемент не зависит от вложенности
+void BM_JsonBuilderBuild(benchmark::State& state) {
+    const size_t items_count = static_cast<size_t>(state.range(0));
+    json::Array items;
+    items.reserve(items_count);
+    for (size_t i = 0; i < items_count; ++i) {
+        items.emplace_back(json::Dict{{"stop_name"s, "Stop name long enough for the heap "s + std::to_string(i)},
+                                      {"time"s, static_cast<double>(i)}});
+    }
+
+    size_t allocations = 0;
+    stats::Enable();
+    for (auto _ : state) {
+        json::Array array = items;
+        const size_t allocation_count = stats::GetAllocationCount();
+        json::Node root = std::move(json::Builder{}.StartDict()
+            .Key("request_id"s).Value(1)
+            .Key("items"s).Value(std::move(array))
+            .EndDict()).Build();
+        allocations += stats::GetAllocationCount() - allocation_count;
+        benchmark::DoNotOptimize(root);
+    }
+    stats::Disable();
+
+    state.SetItemsProcessed(state.iterations() * items_count);
+    state.counters["allocations_per_build"] = state.iterations() == 0
+                                              ? 0.0 : static_cast<double>(allocations) / state.iterations();
+}
+
+} // namespace
+
+BENCHMARK(BM_JsonLoad)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UpdateTransportCatalogue)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TextUpdateTransportCatalogue)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TextLoadTransportCatalogue)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildGraph)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GraphRouterConstruct)->Arg(50)->Arg(100)->Arg(200)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildRoute)->Arg(50)->Arg(100)->Arg(200);
+BENCHMARK(BM_GetSvgDocument)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RenderSvgDocument)->ArgsProduct({{1000, 10000}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MapLevelOfDetail)->ArgsProduct({{1000, 10000}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RenderMap)->ArgsProduct({{1000, 10000}, {0, 1, 2, 4}})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SvgLabels)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SerializationRoundTrip)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MakeBase)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StatRequestDispatch)->RangeMultiplier(10)->Range(100, 10000);
+BENCHMARK(BM_MapRequestDispatch)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_JsonBuilderBuild)->RangeMultiplier(10)->Range(100, 10000);
+BENCHMARK(BM_ProcessRequests)->Arg(50)->Arg(100)->Arg(200)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
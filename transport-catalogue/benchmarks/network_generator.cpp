@@ -0,0 +1,187 @@
+#include "network_generator.h"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+
+namespace benchmarks {
+
+using namespace std::string_literals;
+
+namespace {
+
+json::Dict MakeRenderSettings() {
+    return json::Dict{
+        {"width"s, 1200.0},
+        {"height"s, 800.0},
+        {"padding"s, 50.0},
+        {"stop_radius"s, 5.0},
+        {"line_width"s, 14.0},
+        {"bus_label_font_size"s, 20},
+        {"bus_label_offset"s, json::Array{7.0, 15.0}},
+        {"stop_label_font_size"s, 18},
+        {"stop_label_offset"s, json::Array{7.0, -3.0}},
+        {"underlayer_color"s, json::Array{255, 255, 255, 0.85}},
+        {"underlayer_width"s, 3.0},
+        {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s}},
+    };
+}
+
+json::Dict MakeSerializationSettings(const std::string& db_path) {
+    return json::Dict{{"file"s, db_path}};
+}
+
+} // namespace
+
+std::string GetStopName(size_t index) {
+    return "Stop "s + std::to_string(index);
+}
+
+std::string GetBusName(size_t index) {
+    return std::to_string(index);
+}
+
+json::Document GenerateBaseDocument(const NetworkParams& params, const std::string& db_path) {
+    std::mt19937 generator(params.seed);
+    std::uniform_real_distribution<double> latitude(55.5, 56.0);
+    std::uniform_real_distribution<double> longitude(37.3, 37.9);
+    std::uniform_int_distribution<int> distance(500, 5000);
+    std::uniform_int_distribution<size_t> stop_index(0, params.stops_count - 1);
+
+    const size_t route_length = std::min(std::max<size_t>(params.route_length, 2), params.stops_count);
+
+    std::vector<json::Dict> road_distances(params.stops_count);
+    json::Array buses;
+    buses.reserve(params.buses_count);
+    for (size_t i = 0; i < params.buses_count; ++i) {
+        // Остановки маршрута не повторяются, иначе кольцевой маршрут
+        // замкнулся бы раньше времени
+        std::unordered_set<size_t> used;
+        std::vector<size_t> route;
+        route.reserve(route_length + 1);
+        while (route.size() < route_length) {
+            const size_t stop = stop_index(generator);
+            if (used.insert(stop).second) {
+                route.push_back(stop);
+            }
+        }
+        const bool is_roundtrip = i % 2 == 0;
+        if (is_roundtrip) {
+            route.push_back(route.front());
+        }
+
+        // Расстояние задаётся для каждой пары соседних остановок, у маятниковых
+        // маршрутов — и в обратную сторону, чтобы оно могло отличаться
+        json::Array stops;
+        stops.reserve(route.size());
+        for (size_t j = 0; j < route.size(); ++j) {
+            stops.emplace_back(GetStopName(route[j]));
+            if (j == 0) {
+                continue;
+            }
+            road_distances[route[j - 1]][GetStopName(route[j])] = distance(generator);
+            if (!is_roundtrip) {
+                road_distances[route[j]][GetStopName(route[j - 1])] = distance(generator);
+            }
+        }
+
+        buses.emplace_back(json::Dict{
+            {"type"s, "Bus"s},
+            {"name"s, GetBusName(i)},
+            {"stops"s, std::move(stops)},
+            {"is_roundtrip"s, is_roundtrip},
+        });
+    }
+
+    const size_t extra_distances = static_cast<size_t>(params.distance_density * params.stops_count);
+    for (size_t i = 0; i < extra_distances; ++i) {
+        road_distances[stop_index(generator)][GetStopName(stop_index(generator))] = distance(generator);
+    }
+
+    json::Array base_requests;
+    base_requests.reserve(params.stops_count + params.buses_count);
+    for (size_t i = 0; i < params.stops_count; ++i) {
+        base_requests.emplace_back(json::Dict{
+            {"type"s, "Stop"s},
+            {"name"s, GetStopName(i)},
+            {"latitude"s, latitude(generator)},
+            {"longitude"s, longitude(generator)},
+            {"road_distances"s, std::move(road_distances[i])},
+        });
+    }
+    for (auto& bus : buses) {
+        base_requests.emplace_back(std::move(bus));
+    }
+
+    return json::Document{json::Dict{
+        {"serialization_settings"s, MakeSerializationSettings(db_path)},
+        {"routing_settings"s, json::Dict{{"bus_wait_time"s, 6}, {"bus_velocity"s, 40.0}}},
+        {"render_settings"s, MakeRenderSettings()},
+        {"base_requests"s, std::move(base_requests)},
+    }};
+}
+
+std::string ConvertToText(const json::Document& base_document) {
+    const json::Array& base_requests = base_document.GetRoot().AsDict().at("base_requests"s).AsArray();
+
+    std::ostringstream out;
+    // Координаты выводятся без потери точности
+    out.precision(17);
+    out << base_requests.size() << '\n';
+    for (const auto& node : base_requests) {
+        const json::Dict& request = node.AsDict();
+        if (request.at("type"s).AsString() == "Stop"s) {
+            out << "Stop "s << request.at("name"s).AsString() << ": "s
+                << request.at("latitude"s).AsDouble() << ", "s << request.at("longitude"s).AsDouble();
+            for (const auto& [stop, distance] : request.at("road_distances"s).AsDict()) {
+                out << ", "s << distance.AsInt() << "m to "s << stop;
+            }
+        } else {
+            const char* delim = request.at("is_roundtrip"s).AsBool() ? " > " : " - ";
+            out << "Bus "s << request.at("name"s).AsString() << ": "s;
+            bool is_first = true;
+            for (const auto& stop : request.at("stops"s).AsArray()) {
+                out << (is_first ? "" : delim) << stop.AsString();
+                is_first = false;
+            }
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+json::Document GenerateStatDocument(const NetworkParams& params, const std::string& db_path, size_t requests_count) {
+    std::mt19937 generator(params.seed + 1);
+    std::uniform_int_distribution<size_t> stop_index(0, params.stops_count - 1);
+    std::uniform_int_distribution<size_t> bus_index(0, std::max<size_t>(params.buses_count, 1) - 1);
+
+    json::Array stat_requests;
+    stat_requests.reserve(requests_count + 1);
+    int id = 1;
+    for (size_t i = 0; i < requests_count; ++i, ++id) {
+        switch (i % 3) {
+        case 0:
+            stat_requests.emplace_back(json::Dict{
+                {"id"s, id}, {"type"s, "Bus"s}, {"name"s, GetBusName(bus_index(generator))}});
+            break;
+        case 1:
+            stat_requests.emplace_back(json::Dict{
+                {"id"s, id}, {"type"s, "Stop"s}, {"name"s, GetStopName(stop_index(generator))}});
+            break;
+        default:
+            stat_requests.emplace_back(json::Dict{
+                {"id"s, id}, {"type"s, "Route"s},
+                {"from"s, GetStopName(stop_index(generator))}, {"to"s, GetStopName(stop_index(generator))}});
+            break;
+        }
+    }
+    stat_requests.emplace_back(json::Dict{{"id"s, id}, {"type"s, "Map"s}});
+
+    return json::Document{json::Dict{
+        {"serialization_settings"s, MakeSerializationSettings(db_path)},
+        {"stat_requests"s, std::move(stat_requests)},
+    }};
+}
+
+} // namespace benchmarks
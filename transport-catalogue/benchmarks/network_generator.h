@@ -0,0 +1,38 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstdint>
+#include <string>
+
+namespace benchmarks {
+
+// Параметры синтетической транспортной сети
+struct NetworkParams {
+    size_t stops_count = 100;
+    size_t buses_count = 20;
+    // Число остановок в маршруте одного автобуса
+    size_t route_length = 10;
+    // Среднее число дополнительных дорожных расстояний на остановку,
+    // помимо расстояний между соседними остановками маршрутов
+    double distance_density = 1.0;
+    uint32_t seed = 42;
+};
+
+// Документ для режима make_base: serialization_settings, routing_settings,
+// render_settings и base_requests. Одинаковые параметры дают одинаковый документ
+json::Document GenerateBaseDocument(const NetworkParams& params, const std::string& db_path);
+
+// Запросы base_requests документа для make_base в текстовом формате input_reader:
+// строка с числом запросов, затем по строке «Stop ...» или «Bus ...» на запрос
+std::string ConvertToText(const json::Document& base_document);
+
+// Документ для режима process_requests: requests_count запросов Bus, Stop и Route
+// вперемешку и один запрос Map в конце
+json::Document GenerateStatDocument(const NetworkParams& params, const std::string& db_path, size_t requests_count);
+
+std::string GetStopName(size_t index);
+
+std::string GetBusName(size_t index);
+
+} // namespace benchmarks
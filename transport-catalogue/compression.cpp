@@ -0,0 +1,179 @@
+#include "compression.h"
+
+#include <stdexcept>
+
+#ifdef TRANSPORT_CATALOGUE_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TRANSPORT_CATALOGUE_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef TRANSPORT_CATALOGUE_WITH_LZ4
+#include <lz4.h>
+#endif
+
+namespace compression {
+
+using namespace std::literals;
+
+Codec ParseCodec(std::string_view name) {
+    if (name == "none"sv) {
+        return Codec::None;
+    } else if (name == "zlib"sv) {
+        return Codec::Zlib;
+    } else if (name == "zstd"sv) {
+        return Codec::Zstd;
+    } else if (name == "lz4"sv) {
+        return Codec::Lz4;
+    }
+    throw std::invalid_argument("unknown compression: "s + std::string(name));
+}
+
+std::string_view GetCodecName(Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return "none"sv;
+    case Codec::Zlib:
+        return "zlib"sv;
+    case Codec::Zstd:
+        return "zstd"sv;
+    case Codec::Lz4:
+        return "lz4"sv;
+    }
+    return "unknown"sv;
+}
+
+bool IsAvailable(Codec codec) {
+    switch (codec) {
+    case Codec::None:
+        return true;
+    case Codec::Zlib:
+#ifdef TRANSPORT_CATALOGUE_WITH_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Codec::Zstd:
+#ifdef TRANSPORT_CATALOGUE_WITH_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    case Codec::Lz4:
+#ifdef TRANSPORT_CATALOGUE_WITH_LZ4
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+namespace {
+
+[[noreturn]] void ThrowUnavailable(Codec codec) {
+    throw std::logic_error("compression "s + std::string(GetCodecName(codec)) + " is not supported by this build"s);
+}
+
+[[noreturn]] void ThrowCorrupted(Codec codec) {
+    throw std::runtime_error("corrupted "s + std::string(GetCodecName(codec)) + " block"s);
+}
+
+} // namespace
+
+std::string Compress(Codec codec, std::string_view data, [[maybe_unused]] int level) {
+    if (!IsAvailable(codec)) {
+        ThrowUnavailable(codec);
+    }
+
+    std::string result;
+    switch (codec) {
+    case Codec::None:
+        result = data;
+        break;
+    case Codec::Zlib: {
+#ifdef TRANSPORT_CATALOGUE_WITH_ZLIB
+        uLongf size = compressBound(static_cast<uLong>(data.size()));
+        result.resize(size);
+        if (compress2(reinterpret_cast<Bytef*>(result.data()), &size,
+                      reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()),
+                      level == 0 ? Z_DEFAULT_COMPRESSION : level) != Z_OK) {
+            throw std::runtime_error("zlib compression failed"s);
+        }
+        result.resize(size);
+#endif
+        break;
+    }
+    case Codec::Zstd: {
+#ifdef TRANSPORT_CATALOGUE_WITH_ZSTD
+        result.resize(ZSTD_compressBound(data.size()));
+        const size_t size = ZSTD_compress(result.data(), result.size(), data.data(), data.size(), level);
+        if (ZSTD_isError(size)) {
+            throw std::runtime_error("zstd compression failed: "s + ZSTD_getErrorName(size));
+        }
+        result.resize(size);
+#endif
+        break;
+    }
+    case Codec::Lz4: {
+#ifdef TRANSPORT_CATALOGUE_WITH_LZ4
+        result.resize(LZ4_compressBound(static_cast<int>(data.size())));
+        const int size = LZ4_compress_default(data.data(), result.data(),
+                                              static_cast<int>(data.size()), static_cast<int>(result.size()));
+        if (size <= 0) {
+            throw std::runtime_error("lz4 compression failed"s);
+        }
+        result.resize(size);
+#endif
+        break;
+    }
+    }
+    return result;
+}
+
+void Decompress(Codec codec, std::string_view data, char* output, size_t raw_size) {
+    if (!IsAvailable(codec)) {
+        ThrowUnavailable(codec);
+    }
+
+    switch (codec) {
+    case Codec::None:
+        if (data.size() != raw_size) {
+            ThrowCorrupted(codec);
+        }
+        data.copy(output, raw_size);
+        break;
+    case Codec::Zlib: {
+#ifdef TRANSPORT_CATALOGUE_WITH_ZLIB
+        uLongf size = static_cast<uLongf>(raw_size);
+        if (uncompress(reinterpret_cast<Bytef*>(output), &size,
+                       reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size())) != Z_OK
+            || size != raw_size) {
+            ThrowCorrupted(codec);
+        }
+#endif
+        break;
+    }
+    case Codec::Zstd: {
+#ifdef TRANSPORT_CATALOGUE_WITH_ZSTD
+        const size_t size = ZSTD_decompress(output, raw_size, data.data(), data.size());
+        if (ZSTD_isError(size) || size != raw_size) {
+            ThrowCorrupted(codec);
+        }
+#endif
+        break;
+    }
+    case Codec::Lz4: {
+#ifdef TRANSPORT_CATALOGUE_WITH_LZ4
+        const int size = LZ4_decompress_safe(data.data(), output,
+                                             static_cast<int>(data.size()), static_cast<int>(raw_size));
+        if (size < 0 || static_cast<size_t>(size) != raw_size) {
+            ThrowCorrupted(codec);
+        }
+#endif
+        break;
+    }
+    }
+}
+
+} // namespace compression
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Сжатие блоков файла базы. Доступность алгоритмов определяется при сборке:
+// zlib, zstd и lz4 подключаются, если в системе найдены их заголовки и библиотеки
+namespace compression {
+
+enum class Codec {
+    None,
+    Zlib,
+    Zstd,
+    Lz4,
+};
+
+struct Settings {
+    Codec codec = Codec::None;
+    // 0 — уровень сжатия алгоритма по умолчанию. Для lz4 не используется
+    int level = 0;
+    // Секции базы делятся на блоки не больше block_size байт,
+    // каждый блок сжимается и распаковывается независимо
+    size_t block_size = 4 << 20;
+};
+
+// Название алгоритма в serialization_settings: none, zlib, zstd или lz4
+Codec ParseCodec(std::string_view name);
+
+std::string_view GetCodecName(Codec codec);
+
+bool IsAvailable(Codec codec);
+
+std::string Compress(Codec codec, std::string_view data, int level);
+
+// Распаковывает data в буфер output размером ровно raw_size байт
+void Decompress(Codec codec, std::string_view data, char* output, size_t raw_size);
+
+} // namespace compression
@@ -3,7 +3,7 @@
 namespace domain {
 
 size_t Stop::Hash() const {
-    return std::hash<std::string>{}(name)
+    return std::hash<std::string_view>{}(name)
            + 37 * std::hash<double>{}(point.lng)
            + 37 * 37 * std::hash<double>{}(point.lat);
 }
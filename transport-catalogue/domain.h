@@ -2,7 +2,9 @@
 
 #include "geo.h"
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace domain {
@@ -13,21 +15,94 @@ enum class RouteType {
 };
 
 struct Stop {
-    std::string name;
+    // Строка из пула названий справочника (см. TransportCatalogue::AddStop)
+    std::string_view name;
     geo::Coordinates point;
+    // Номер остановки в справочнике в порядке добавления, назначается TransportCatalogue::AddStop
+    size_t id = 0;
 
     size_t Hash() const;
 };
 
+// Расписание рейсов автобуса: отправления от начальной остановки маршрута
+// с first_departure до last_departure включительно с интервалом headway.
+// Время задаётся в минутах от начала суток
+struct Schedule {
+    double first_departure = 0.0;
+    double last_departure = 0.0;
+    double headway = 0.0;
+};
+
+// Остановки маршрута автобуса — участок общего массива остановок маршрутов
+// всех автобусов справочника (см. TransportCatalogue::AddBus). Не владеет данными
+class StopSpan {
+public:
+    using const_iterator = const Stop* const*;
+
+    StopSpan() = default;
+
+    StopSpan(const Stop* const* data, size_t size)
+        : data_(data)
+        , size_(size) {
+    }
+
+    const_iterator begin() const {
+        return data_;
+    }
+
+    const_iterator end() const {
+        return data_ + size_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const Stop* operator[](size_t index) const {
+        return data_[index];
+    }
+
+    const Stop* front() const {
+        return data_[0];
+    }
+
+    const Stop* back() const {
+        return data_[size_ - 1];
+    }
+
+private:
+    const Stop* const* data_ = nullptr;
+    size_t size_ = 0;
+};
+
 struct Bus {
-    std::string number;
+    // Строка из пула названий справочника (см. TransportCatalogue::AddBus)
+    std::string_view number;
     RouteType route_type;
-    std::vector<const Stop*> stops;
+    // Задаётся справочником при добавлении автобуса
+    StopSpan stops;
     size_t route_stops_count;
     size_t unique_stops_count;
     size_t route_length;
     double curvature;
     const Stop* final_stop = nullptr;
+    std::optional<Schedule> schedule;
+    // Номер автобуса в справочнике в порядке добавления, назначается TransportCatalogue::AddBus
+    size_t id = 0;
+};
+
+// Участок маршрута поездки: ожидание автобуса на остановке from_stop
+// и поездка на нём через span_count перегонов
+struct RouteLeg {
+    const Bus* bus;
+    const Stop* from_stop;
+    size_t span_count;
+    double wait_time;
+    double ride_time;
 };
 
 } // namespace domain
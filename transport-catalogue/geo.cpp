@@ -1,20 +1,167 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GEO_USE_SSE2
+#endif
+
 namespace geo {
 
+namespace {
+
+const double dr = 3.1415926535 / 180.;
+const double earthRadiusM = 6371000;
+
+// Количество пар точек, обрабатываемых пакетным расчётом за один проход.
+// Промежуточные результаты блока помещаются на стеке и в кэше L1
+constexpr size_t BLOCK_SIZE = 64;
+
+// Векторная часть пакетного расчёта: для пар (points[i], points[i + 1])
+// вычисляет произведения синусов и косинусов широт и разность долгот в радианах.
+// Операции и их порядок те же, что и в скалярной формуле, поэтому результат совпадает бит в бит
+void ComputeBlockTerms(const PreparedCoordinates* points, size_t count,
+                       double* sin_products, double* cos_products, double* delta_lng) {
+    size_t i = 0;
+#ifdef GEO_USE_SSE2
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    const __m128d dr_vec = _mm_set1_pd(dr);
+    for (; i + 2 <= count; i += 2) {
+        const PreparedCoordinates& a0 = points[i];
+        const PreparedCoordinates& a1 = points[i + 1];
+        const PreparedCoordinates& b1 = points[i + 2];
+
+        const __m128d sin_from = _mm_set_pd(a1.sin_lat, a0.sin_lat);
+        const __m128d sin_to = _mm_set_pd(b1.sin_lat, a1.sin_lat);
+        const __m128d cos_from = _mm_set_pd(a1.cos_lat, a0.cos_lat);
+        const __m128d cos_to = _mm_set_pd(b1.cos_lat, a1.cos_lat);
+        const __m128d lng_from = _mm_set_pd(a1.point.lng, a0.point.lng);
+        const __m128d lng_to = _mm_set_pd(b1.point.lng, a1.point.lng);
+
+        _mm_storeu_pd(sin_products + i, _mm_mul_pd(sin_from, sin_to));
+        _mm_storeu_pd(cos_products + i, _mm_mul_pd(cos_from, cos_to));
+        const __m128d abs_delta = _mm_andnot_pd(sign_mask, _mm_sub_pd(lng_from, lng_to));
+        _mm_storeu_pd(delta_lng + i, _mm_mul_pd(abs_delta, dr_vec));
+    }
+#endif
+    for (; i < count; ++i) {
+        sin_products[i] = points[i].sin_lat * points[i + 1].sin_lat;
+        cos_products[i] = points[i].cos_lat * points[i + 1].cos_lat;
+        delta_lng[i] = std::abs(points[i].point.lng - points[i + 1].point.lng) * dr;
+    }
+}
+
+void CombineBlockTerms(const double* sin_products, const double* cos_products,
+                       const double* cos_delta_lng, size_t count, double* result) {
+    size_t i = 0;
+#ifdef GEO_USE_SSE2
+    for (; i + 2 <= count; i += 2) {
+        const __m128d cos_term = _mm_mul_pd(_mm_loadu_pd(cos_products + i), _mm_loadu_pd(cos_delta_lng + i));
+        _mm_storeu_pd(result + i, _mm_add_pd(_mm_loadu_pd(sin_products + i), cos_term));
+    }
+#endif
+    for (; i < count; ++i) {
+        result[i] = sin_products[i] + cos_products[i] * cos_delta_lng[i];
+    }
+}
+
+double HaversineTerm(double sin_half_delta_lat, double sin_half_delta_lng, double cos_products) {
+    return sin_half_delta_lat * sin_half_delta_lat
+         + cos_products * sin_half_delta_lng * sin_half_delta_lng;
+}
+
+} // namespace
+
+PreparedCoordinates PrepareCoordinates(Coordinates point) {
+    return {point, std::sin(point.lat * dr), std::cos(point.lat * dr)};
+}
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
         return 0;
     }
-    static const double dr = 3.1415926535 / 180.;
-    static const double earthRadiusM = 6371000;
     return acos(sin(from.lat * dr) * sin(to.lat * dr)
               + cos(from.lat * dr) * cos(to.lat * dr)
               * cos(abs(from.lng - to.lng) * dr)) * earthRadiusM;
 }
 
+double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    if (from.point == to.point) {
+        return 0;
+    }
+    return std::acos(from.sin_lat * to.sin_lat
+                   + from.cos_lat * to.cos_lat
+                   * std::cos(std::abs(from.point.lng - to.point.lng) * dr)) * earthRadiusM;
+}
+
+void ComputeDistances(const PreparedCoordinates* points, size_t count, double* distances) {
+    if (count < 2) {
+        return;
+    }
+    double sin_products[BLOCK_SIZE];
+    double cos_products[BLOCK_SIZE];
+    double delta_lng[BLOCK_SIZE];
+    double central_cos[BLOCK_SIZE];
+
+    const size_t pairs_count = count - 1;
+    for (size_t begin = 0; begin < pairs_count; begin += BLOCK_SIZE) {
+        const size_t block_size = std::min(BLOCK_SIZE, pairs_count - begin);
+        const PreparedCoordinates* block = points + begin;
+
+        ComputeBlockTerms(block, block_size, sin_products, cos_products, delta_lng);
+        // Косинус и арккосинус считаются стандартной библиотекой, чтобы результат
+        // не отличался от скалярной ComputeDistance
+        for (size_t i = 0; i < block_size; ++i) {
+            delta_lng[i] = std::cos(delta_lng[i]);
+        }
+        CombineBlockTerms(sin_products, cos_products, delta_lng, block_size, central_cos);
+        for (size_t i = 0; i < block_size; ++i) {
+            distances[begin + i] = block[i].point == block[i + 1].point
+                                 ? 0.0
+                                 : std::acos(central_cos[i]) * earthRadiusM;
+        }
+    }
+}
+
+std::vector<double> ComputeDistances(const std::vector<PreparedCoordinates>& points) {
+    if (points.size() < 2) {
+        return {};
+    }
+    std::vector<double> result(points.size() - 1);
+    ComputeDistances(points.data(), points.size(), result.data());
+    return result;
+}
+
+double ComputeRouteDistance(const std::vector<PreparedCoordinates>& points) {
+    double result = 0.0;
+    for (double distance : ComputeDistances(points)) {
+        result += distance;
+    }
+    return result;
+}
+
+double ComputeHaversineDistance(Coordinates from, Coordinates to) {
+    return ComputeHaversineDistance(PrepareCoordinates(from), PrepareCoordinates(to));
+}
+
+double ComputeHaversineDistance(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    if (from.point == to.point) {
+        return 0;
+    }
+    const double sin_half_delta_lat = std::sin((to.point.lat - from.point.lat) * dr / 2);
+    const double sin_half_delta_lng = std::sin((to.point.lng - from.point.lng) * dr / 2);
+    const double h = HaversineTerm(sin_half_delta_lat, sin_half_delta_lng, from.cos_lat * to.cos_lat);
+    return 2 * std::asin(std::sqrt(std::min(h, 1.0))) * earthRadiusM;
+}
+
+void ComputeHaversineDistances(const PreparedCoordinates* points, size_t count, double* distances) {
+    for (size_t i = 0; i + 1 < count; ++i) {
+        distances[i] = ComputeHaversineDistance(points[i], points[i + 1]);
+    }
+}
+
 } // namespace geo
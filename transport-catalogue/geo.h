@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace geo {
 
 struct Coordinates {
@@ -13,6 +16,44 @@ struct Coordinates {
     }
 };
 
+// Координаты точки с заранее вычисленными синусом и косинусом широты.
+// Подготовленную точку можно использовать в любом количестве пар,
+// не повторяя тригонометрических вычислений для каждой из них
+struct PreparedCoordinates {
+    Coordinates point;
+    double sin_lat = 0.0;
+    double cos_lat = 0.0;
+};
+
+PreparedCoordinates PrepareCoordinates(Coordinates point);
+
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Результат совпадает с ComputeDistance(from.point, to.point) бит в бит
+double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to);
+
+// Вычисляет расстояния между соседними точками массива points:
+// distances[i] — расстояние от points[i] до points[i + 1].
+// Результаты совпадают с ComputeDistance бит в бит, поэтому пакетный расчёт
+// не меняет ни длину маршрута, ни извилистость (curvature)
+void ComputeDistances(const PreparedCoordinates* points, size_t count, double* distances);
+
+std::vector<double> ComputeDistances(const std::vector<PreparedCoordinates>& points);
+
+// Длина ломаной, проходящей через точки points, — сумма ComputeDistances
+// в порядке следования точек
+double ComputeRouteDistance(const std::vector<PreparedCoordinates>& points);
+
+// Расстояние по формуле гаверсинусов. Устойчиво на малых расстояниях,
+// где арккосинус в ComputeDistance теряет точность. На расстояниях
+// от 100 метров до 20 000 км относительное отличие от ComputeDistance
+// не превышает HAVERSINE_TOLERANCE
+inline constexpr double HAVERSINE_TOLERANCE = 1e-6;
+
+double ComputeHaversineDistance(Coordinates from, Coordinates to);
+
+double ComputeHaversineDistance(const PreparedCoordinates& from, const PreparedCoordinates& to);
+
+void ComputeHaversineDistances(const PreparedCoordinates* points, size_t count, double* distances);
+
 } // namespace geo
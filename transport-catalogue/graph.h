@@ -5,15 +5,19 @@
 #include <cstdlib>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace graph {
 
 using VertexId = size_t;
 using EdgeId = size_t;
 
+// Название ребра — название остановки или номер автобуса. Граф не владеет названием:
+// обычно это строка из пула названий справочника
 template <typename Weight>
 struct Edge {
-    std::string name;
+    std::string_view name;
     size_t span_count;
     VertexId from;
     VertexId to;
@@ -36,6 +40,7 @@ public:
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 private:
@@ -51,8 +56,8 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(std::vector<Edge<Weight>> edges,
     std::vector<std::vector<EdgeId>> incidence_lists)
-    : edges_(edges)
-    , incidence_lists_(incidence_lists) {
+    : edges_(std::move(edges))
+    , incidence_lists_(std::move(incidence_lists)) {
 }
 
 template <typename Weight>
@@ -78,6 +83,11 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
     return edges_.at(edge_id);
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
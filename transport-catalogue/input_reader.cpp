@@ -1,5 +1,10 @@
 #include "input_reader.h"
 #include "geo.h"
+#include "mapped_file.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace transport_catalogue {
@@ -22,7 +27,51 @@ std::string GetToken(std::string& line, const std::string& delim) {
 
 } // namespace detail
 
-using namespace std::string_literals;
+using namespace std::literals;
+
+namespace {
+
+// Отрезает от text начало до разделителя delim вместе с разделителем.
+// Если разделителя нет, возвращает text целиком
+std::string_view NextToken(std::string_view& text, std::string_view delim) {
+    const size_t pos = text.find(delim);
+    const std::string_view token = text.substr(0, pos);
+    text.remove_prefix(pos == std::string_view::npos ? text.size() : pos + delim.size());
+    return token;
+}
+
+std::string_view NextLine(std::string_view& text) {
+    std::string_view line = NextToken(text, "\n"sv);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+// Число в начале text: как и std::stod, пропускает ведущие пробелы,
+// но без промежуточной строки
+template <typename Number>
+Number ParseNumber(std::string_view text) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    Number value{};
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr == text.data()) {
+        throw std::invalid_argument("invalid number '"s + std::string(text) + "'"s);
+    }
+    return value;
+}
+
+const Stop* FindRouteStop(const TransportCatalogue& db, std::string_view name) {
+    const Stop* stop = db.FindStop(name);
+    if (stop == nullptr) {
+        throw std::logic_error("Unknown stop '"s + std::string(name) + "'"s);
+    }
+    return stop;
+}
+
+} // namespace
 
 void ParseStopQueries(TransportCatalogue& db, std::vector<std::pair<std::string, std::string>>& stop_queries) {
     for (auto& stop_query : stop_queries) {
@@ -37,8 +86,11 @@ void ParseStopQueries(TransportCatalogue& db, std::vector<std::pair<std::string,
 void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queries) {
     for (std::string& bus_query : bus_queries) {
         Bus bus;
+        std::vector<const Stop*> stops;
         
-        bus.number = detail::GetToken(bus_query, ": "s);
+        // Номер копируется в справочник при добавлении автобуса
+        const std::string number = detail::GetToken(bus_query, ": "s);
+        bus.number = number;
 
         std::string delim;
 
@@ -62,7 +114,7 @@ void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queri
             prev_stop = std::move(curr_stop);
             curr_stop = detail::GetToken(bus_query, delim);
             const Stop* bus_stop = db.FindStop(curr_stop);
-            bus.stops.emplace_back(bus_stop);
+            stops.emplace_back(bus_stop);
             unique_stops.emplace(bus_stop);
             if (bus.route_stops_count) {
                 calc_route_length += ComputeDistance(
@@ -80,7 +132,7 @@ void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queri
 
         if (bus.route_type == RouteType::Circular) {
             ++bus.route_stops_count;
-            bus.stops.emplace_back(db.FindStop(first_stop));
+            stops.emplace_back(db.FindStop(first_stop));
             calc_route_length += ComputeDistance(
                                     db.FindStop(curr_stop)->point,
                                     db.FindStop(first_stop)->point);	
@@ -90,11 +142,10 @@ void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queri
             prev_stop = std::move(curr_stop);
             curr_stop = detail::GetToken(bus_query, delim);
             unique_stops.emplace(db.FindStop(curr_stop));
-            std::vector<const Stop*> temp_stops(bus.stops);
-            bus.stops.emplace_back(db.FindStop(curr_stop));
-            bus.final_stop = bus.stops.back();
-            for (int i = temp_stops.size() - 1; i >= 0; --i) {
-                bus.stops.emplace_back(temp_stops[i]);
+            stops.emplace_back(db.FindStop(curr_stop));
+            bus.final_stop = stops.back();
+            for (int i = static_cast<int>(stops.size()) - 2; i >= 0; --i) {
+                stops.emplace_back(stops[i]);
             }
             calc_route_length += ComputeDistance(
                                     db.FindStop(prev_stop)->point,
@@ -106,14 +157,120 @@ void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queri
 
         bus.unique_stops_count = unique_stops.size();
         bus.curvature = bus.route_length / calc_route_length;
-        std::string bus_number = bus.number;
 
-        db.AddBus(std::move(bus));
+        db.AddBus(std::move(bus), stops);
+    }
+}
+
+void LoadTransportCatalogue(TransportCatalogue& db, std::string_view text) {
+    const size_t queries_count = ParseNumber<size_t>(NextLine(text));
 
-        for (const auto& stop : unique_stops) {
-            db.AddBusThroughStop(stop, bus_number);
+    // Расстояния и маршруты могут ссылаться на остановки из следующих строк, поэтому
+    // строки сначала только раскладываются по типам: после этого известно,
+    // сколько места зарезервировать в справочнике
+    std::vector<std::string_view> stop_queries;
+    std::vector<std::string_view> bus_queries;
+    for (size_t i = 0; i < queries_count; ++i) {
+        if (text.empty()) {
+            throw std::invalid_argument("expected "s + std::to_string(queries_count) + " queries, got "s
+                                        + std::to_string(i));
         }
+        std::string_view line = NextLine(text);
+        const std::string_view query_type = NextToken(line, " "sv);
+        if (query_type == "Stop"sv) {
+            stop_queries.push_back(line);
+        } else if (query_type == "Bus"sv) {
+            bus_queries.push_back(line);
+        }
+    }
+    db.Reserve(stop_queries.size(), bus_queries.size(), 0);
+
+    // Остаток строки остановки после координат — её дорожные расстояния
+    std::vector<std::pair<std::string_view, std::string_view>> distance_queries;
+    for (std::string_view query : stop_queries) {
+        Stop stop;
+        stop.name = NextToken(query, ": "sv);
+        stop.point.lat = ParseNumber<double>(NextToken(query, ", "sv));
+        stop.point.lng = ParseNumber<double>(NextToken(query, ", "sv));
+        if (!query.empty()) {
+            distance_queries.emplace_back(stop.name, query);
+        }
+        db.AddStop(std::move(stop));
     }
+
+    // Каждое расстояние записывается как "<число>m to <остановка>"
+    for (auto [from_stop, query] : distance_queries) {
+        while (!query.empty()) {
+            std::string_view to_stop = NextToken(query, ", "sv);
+            const size_t separator_pos = to_stop.find("m to "sv);
+            if (separator_pos == std::string_view::npos) {
+                throw std::invalid_argument("invalid distance '"s + std::string(to_stop) + "'"s);
+            }
+            const size_t distance = ParseNumber<size_t>(to_stop.substr(0, separator_pos));
+            to_stop.remove_prefix(separator_pos + "m to "sv.size());
+            FindRouteStop(db, to_stop);
+            db.AddDistanceBetweenStops(from_stop, distance, to_stop);
+        }
+    }
+
+    // Буферы и метки посещённых остановок общие для всех автобусов
+    std::unordered_map<const Stop*, geo::PreparedCoordinates> prepared_stops;
+    std::vector<const Stop*> stops;
+    std::vector<geo::PreparedCoordinates> route_points;
+    std::vector<size_t> last_bus(db.GetAllRawStops().size(), bus_queries.size());
+    for (size_t bus_index = 0; bus_index < bus_queries.size(); ++bus_index) {
+        std::string_view query = bus_queries[bus_index];
+        Bus bus;
+        bus.number = NextToken(query, ": "sv);
+        bus.route_type = query.find(" > "sv) != std::string_view::npos ? RouteType::Circular : RouteType::Pendulum;
+        const std::string_view delim = bus.route_type == RouteType::Circular ? " > "sv : " - "sv;
+
+        stops.clear();
+        route_points.clear();
+        bus.unique_stops_count = 0;
+        bus.route_length = 0;
+        while (!query.empty()) {
+            const Stop* stop = FindRouteStop(db, NextToken(query, delim));
+            if (last_bus[stop->id] != bus_index) {
+                last_bus[stop->id] = bus_index;
+                ++bus.unique_stops_count;
+            }
+            auto [it, inserted] = prepared_stops.try_emplace(stop);
+            if (inserted) {
+                it->second = geo::PrepareCoordinates(stop->point);
+            }
+            route_points.push_back(it->second);
+            if (!stops.empty()) {
+                bus.route_length += db.GetDistanceBetweenStops(stops.back()->name, stop->name);
+                if (bus.route_type == RouteType::Pendulum) {
+                    bus.route_length += db.GetDistanceBetweenStops(stop->name, stops.back()->name);
+                }
+            }
+            stops.push_back(stop);
+        }
+        bus.route_stops_count = stops.size();
+        double calc_route_length = geo::ComputeRouteDistance(route_points);
+
+        // Маятниковый маршрут разворачивается в обе стороны, как при загрузке из JSON
+        if (bus.route_type == RouteType::Pendulum && !stops.empty()) {
+            bus.final_stop = stops.back();
+            bus.route_stops_count = bus.route_stops_count * 2 - 1;
+            for (int i = static_cast<int>(stops.size()) - 2; i >= 0; --i) {
+                stops.push_back(stops[i]);
+            }
+            calc_route_length *= 2;
+        }
+        bus.curvature = bus.route_length / calc_route_length;
+
+        db.AddBus(std::move(bus), stops);
+    }
+
+    db.BuildBusesThroughStops();
+}
+
+void LoadTransportCatalogue(TransportCatalogue& db, const std::filesystem::path& path) {
+    const mapped_file::MappedFile file(path);
+    LoadTransportCatalogue(db, file.GetData());
 }
 
 void UpdateTransportCatalogue(TransportCatalogue& db, std::istream& is) {
@@ -136,13 +293,14 @@ void UpdateTransportCatalogue(TransportCatalogue& db, std::istream& is) {
         if (query_type == "Stop"s)	{
             Stop stop;
 
-            stop.name = detail::GetToken(line, ": "s);
+            std::string name = detail::GetToken(line, ": "s);
+            stop.name = name;
             stop.point.lat = std::stod(detail::GetToken(line, ", "s));
             stop.point.lng = std::stod(detail::GetToken(line, ", "s));
 
-            stop_queries.emplace_back(stop.name, std::move(line));
-
             db.AddStop(std::move(stop));
+
+            stop_queries.emplace_back(std::move(name), std::move(line));
         } else if (query_type == "Bus"s) {
             bus_queries.emplace_back(std::move(line));
         }
@@ -151,6 +309,8 @@ void UpdateTransportCatalogue(TransportCatalogue& db, std::istream& is) {
     ParseStopQueries(db, stop_queries);
 
     ParseBusQueries(db, bus_queries);
+
+    db.BuildBusesThroughStops();
 }
 
 } // namespace input_queries_utils
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "transport_catalogue.h"
+#include <filesystem>
 #include <iostream>
+#include <string_view>
 #include <vector>
 
 namespace transport_catalogue {
@@ -14,6 +16,17 @@ void ParseBusQueries(TransportCatalogue& db, std::vector<std::string>& bus_queri
 
 void UpdateTransportCatalogue(TransportCatalogue& db, std::istream& is);
 
+// Заполняет справочник запросами текстового формата, как UpdateTransportCatalogue(db, is),
+// но за один проход по text: строки и поля разбираются как string_view без копирования,
+// названия копируются только в пул справочника. Остановки, расстояния и автобусы
+// добавляются в том же порядке и с теми же характеристиками маршрутов, что и из JSON.
+// При ошибке в числе выбрасывается std::invalid_argument, при неизвестной остановке —
+// std::logic_error
+void LoadTransportCatalogue(TransportCatalogue& db, std::string_view text);
+
+// То же для файла, отображённого в память
+void LoadTransportCatalogue(TransportCatalogue& db, const std::filesystem::path& path);
+
 } // namespace input_queries_utils
 
 } // namespace transport_catalogue
@@ -1,6 +1,7 @@
 #include "json.h"
 
 #include <iterator>
+#include <sstream>
 
 namespace json {
 
@@ -330,6 +331,27 @@ void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
     out.put('}');
 }
 
+// Текст фрагмента выводится построчно, каждая непустая строка после первой сдвигается
+// на отступ узла (пустая строка есть внутри пустого массива или словаря).
+// Переводы строк внутри строковых значений экранированы, поэтому все они — границы строк
+void PrintFragmentText(std::string_view text, const PrintContext& ctx) {
+    for (size_t pos = text.find('\n'); pos != text.npos; pos = text.find('\n')) {
+        ctx.out.write(text.data(), pos + 1);
+        text.remove_prefix(pos + 1);
+        if (text.empty() || text.front() != '\n') {
+            ctx.PrintIndent();
+        }
+    }
+    ctx.out.write(text.data(), text.size());
+}
+
+template <>
+void PrintValue<Fragment>(const Fragment& fragment, const PrintContext& ctx) {
+    PrintFragmentText(fragment.prefix, ctx);
+    ctx.out << fragment.value;
+    PrintFragmentText(fragment.suffix, ctx);
+}
+
 void PrintNode(const Node& node, const PrintContext& ctx) {
     std::visit(
         [&ctx](const auto& value) {
@@ -444,4 +466,65 @@ void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+ArrayWriter::ArrayWriter(std::ostream& output)
+    : output_(output) {
+    output_ << "[\n"sv;
+}
+
+ArrayWriter::~ArrayWriter() {
+    Finish();
+}
+
+void ArrayWriter::Write(const Node& node) {
+    if (is_finished_) {
+        throw std::logic_error("array is already finished"s);
+    }
+    if (!is_empty_) {
+        output_ << ",\n"sv;
+    }
+    is_empty_ = false;
+    const PrintContext ctx = PrintContext{output_}.Indented();
+    ctx.PrintIndent();
+    PrintNode(node, ctx);
+}
+
+void ArrayWriter::Finish() {
+    if (is_finished_) {
+        return;
+    }
+    is_finished_ = true;
+    output_ << "\n]"sv;
+}
+
+std::pair<std::string, std::string> PrintFragment(const Dict& dict, const std::string& key) {
+    std::ostringstream prefix;
+    std::ostringstream suffix;
+    const PrintContext prefix_ctx = PrintContext{prefix}.Indented();
+    const PrintContext suffix_ctx = PrintContext{suffix}.Indented();
+    const auto key_pos = dict.lower_bound(key);
+
+    prefix << "{\n"sv;
+    for (auto it = dict.begin(); it != key_pos; ++it) {
+        prefix_ctx.PrintIndent();
+        PrintString(it->first, prefix);
+        prefix << ": "sv;
+        PrintNode(it->second, prefix_ctx);
+        prefix << ",\n"sv;
+    }
+    prefix_ctx.PrintIndent();
+    PrintString(key, prefix);
+    prefix << ": "sv;
+
+    for (auto it = key_pos; it != dict.end(); ++it) {
+        suffix << ",\n"sv;
+        suffix_ctx.PrintIndent();
+        PrintString(it->first, suffix);
+        suffix << ": "sv;
+        PrintNode(it->second, suffix_ctx);
+    }
+    suffix << "\n}"sv;
+
+    return {prefix.str(), suffix.str()};
+}
+
 }  // namespace json
@@ -3,22 +3,39 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
+// Прозрачное сравнение позволяет искать ключи по std::string_view без создания строк
+using Dict = std::map<std::string, Node, std::less<>>;
 using Array = std::vector<Node>;
 
+// Заранее сериализованное значение, в которое при выводе подставляется одно целое число:
+// выводятся текст prefix, число value и текст suffix. Текст отформатирован как значение
+// верхнего уровня документа и при выводе сдвигается на отступ узла.
+// Узел не владеет текстом: текст должен существовать, пока узел используется
+struct Fragment {
+    std::string_view prefix;
+    int value = 0;
+    std::string_view suffix;
+};
+
+inline bool operator==(const Fragment& lhs, const Fragment& rhs) {
+    return lhs.prefix == rhs.prefix && lhs.value == rhs.value && lhs.suffix == rhs.suffix;
+}
+
 class ParsingError : public std::runtime_error {
 public:
     using runtime_error::runtime_error;
 };
 
 class Node final
-    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, Fragment> {
 public:
     using variant::variant;
     using Value = variant;
@@ -68,6 +85,11 @@ public:
         : root_(std::move(root)) {
     }
 
+    // Корень-словарь строится сразу в документе, без промежуточного Node
+    explicit Document(Dict root)
+        : root_(std::move(root)) {
+    }
+
     const Node& GetRoot() const;
 
 private:
@@ -86,4 +108,33 @@ Document Load(std::istream& input);
 
 void Print(const Document& doc, std::ostream& output);
 
+// Выводит массив — корень документа — по одному элементу, так же, как его вывел бы Print:
+// «[» выводится при создании, элементы — по мере добавления, «]» — в Finish
+// или при разрушении. Сам массив в памяти не накапливается
+class ArrayWriter {
+public:
+    explicit ArrayWriter(std::ostream& output);
+
+    ArrayWriter(const ArrayWriter&) = delete;
+    ArrayWriter& operator=(const ArrayWriter&) = delete;
+
+    ~ArrayWriter();
+
+    void Write(const Node& node);
+
+    // Завершает массив. Повторные вызовы ничего не делают, Write после Finish
+    // выбрасывает std::logic_error
+    void Finish();
+
+private:
+    std::ostream& output_;
+    bool is_empty_ = true;
+    bool is_finished_ = false;
+};
+
+// Сериализует словарь dict так, как его вывел бы Print, с ключом key, значение которого
+// подставляется позже: возвращает текст до и после значения для json::Fragment.
+// Ключа key в словаре быть не должно
+std::pair<std::string, std::string> PrintFragment(const Dict& dict, const std::string& key);
+
 }  // namespace json
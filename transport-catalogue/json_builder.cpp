@@ -7,7 +7,7 @@ namespace json {
         : builder_(builder) {
     }
     Builder::DictItemContext Builder::KeyContext::Value(Node::Value value) {
-        return DictItemContext(builder_.Value(value));
+        return DictItemContext(builder_.Value(std::move(value)));
     }
     Builder::DictItemContext Builder::KeyContext::StartDict() {
         return builder_.StartDict();
@@ -19,8 +19,8 @@ namespace json {
     Builder::DictItemContext::DictItemContext(Builder& builder) 
         : builder_(builder) {
     }
-    Builder::KeyContext Builder::DictItemContext::Key(const std::string& key) {
-        return builder_.Key(key);
+    Builder::KeyContext Builder::DictItemContext::Key(std::string key) {
+        return builder_.Key(std::move(key));
     }
     Builder& Builder::DictItemContext::EndDict() {
         return builder_.EndDict();
@@ -30,7 +30,7 @@ namespace json {
         : builder_(builder) {
     }
     Builder::ArrayItemContext Builder::ArrayItemContext::Value(Node::Value value) {
-        return ArrayItemContext(builder_.Value(value));
+        return ArrayItemContext(builder_.Value(std::move(value)));
     }
     Builder::DictItemContext Builder::ArrayItemContext::StartDict() {
         return builder_.StartDict();
@@ -46,7 +46,7 @@ namespace json {
         nodes_stack_.push_back(&root_);
     }
 
-    Node* Builder::AddItem(Node::Value value) {
+    Node* Builder::AddItem(Node::Value&& value) {
         Node node;
         node.GetValue() = move(value);
 
@@ -61,7 +61,7 @@ namespace json {
                 throw std::logic_error("Ошибка: добавление элемента в словарь без ключа."s);
             }
             Dict& dict = const_cast<Dict&>(node_ptr->AsDict());
-            const auto ptr = dict.emplace(key_.value(), node);
+            const auto ptr = dict.emplace(std::move(*key_), std::move(node));
             key_ = std::nullopt;
             return &ptr.first->second;
         } else if (node_ptr->IsArray()) {
@@ -69,7 +69,7 @@ namespace json {
                 throw std::logic_error("Ошибка: добавление ключа в массив."s);
             }
             Array& array = const_cast<Array&>(node_ptr->AsArray());
-            array.emplace_back(node);
+            array.emplace_back(std::move(node));
             return &array.back();
         }
         return nullptr;
@@ -91,7 +91,7 @@ namespace json {
         if (nodes_stack_.empty()) {
             throw std::logic_error("Ошибка: вызов любого метода, кроме Build(), при готовом объекте."s);
         }
-        AddItem(value);
+        AddItem(std::move(value));
 
         return *this;
     }
@@ -132,11 +132,15 @@ namespace json {
         return *this;
     }
 
-    Node& Builder::Build() {
+    Node& Builder::Build() & {
         if (!nodes_stack_.empty() || root_.IsNull()) {
             throw std::logic_error("Вызов метода Build() при неготовом описываемом объекте."s);
         }
         return root_;
     }
 
+    Node Builder::Build() && {
+        return std::move(Build());
+    }
+
 }  // namespace json
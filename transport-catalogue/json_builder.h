@@ -26,7 +26,7 @@ public:
         friend class Builder;
     public:
         DictItemContext(Builder& builder);
-        KeyContext Key(const std::string& key);
+        KeyContext Key(std::string key);
         Builder& EndDict();
     private:
         Builder& builder_;
@@ -81,7 +81,12 @@ public:
     // вызовами методов. К этому моменту для каждого Start* должен быть вызван
     // соответствующий End*. При этом сам объект должен быть определён,
     // то есть вызов json::Builder{}.Build() недопустим.
-    Node& Build();
+    Node& Build() &;
+
+    // То же для временного или перемещаемого построителя: готовый объект
+    // не копируется, а переносится из построителя. Цепочка вызовов от временного
+    // объекта возвращает Builder&, поэтому её завершают как std::move(...).Build()
+    Node Build() &&;
 
 private:
     // сам конструируемый объект
@@ -94,7 +99,9 @@ private:
 
     std::optional<std::string> key_;
 
-    Node* AddItem(Node::Value value);
+    // Значение принимается по ссылке: лишнее перемещение Node::Value через параметр
+    // GCC 12 в Release принимает за чтение неинициализированной альтернативы варианта
+    Node* AddItem(Node::Value&& value);
 };
 
 }  // namespace json
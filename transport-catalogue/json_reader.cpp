@@ -1,12 +1,13 @@
 #include "json_reader.h"
-#include "json_builder.h"
 #include "geo.h"
+#include "stats.h"
+#include <unordered_map>
 #include <unordered_set>
 #include <sstream>
 
 namespace transport_catalogue {
 
-using namespace std::string_literals;
+using namespace std::literals;
 
 std::pair<Stop, bool> JsonReader::ParseStopRequest(const Dict& request) const {
     Stop stop;
@@ -19,58 +20,104 @@ std::pair<Stop, bool> JsonReader::ParseStopRequest(const Dict& request) const {
     return {std::move(stop), has_road_distances};
 }
 
+namespace {
+
+using PreparedStops = std::unordered_map<const Stop*, geo::PreparedCoordinates>;
+
+// Собирает автобус по списку остановок в том виде, в каком он задан в запросе
+// (маятниковый маршрут — в одну сторону), и вычисляет характеристики маршрута.
+// Маятниковый маршрут дополняется в stops обратным направлением.
+// Синусы и косинусы широт кэшируются в prepared_stops и вычисляются один раз
+// для каждой остановки, сколько бы маршрутов через неё ни проходило
+Bus MakeBus(const TransportCatalogue& db, std::string_view number, RouteType route_type,
+    std::vector<const Stop*>& stops, PreparedStops& prepared_stops) {
+
+    Bus bus;
+    bus.number = number;
+    bus.route_type = route_type;
+    bus.route_stops_count = stops.size();
+    bus.route_length = 0;
+
+    std::vector<geo::PreparedCoordinates> route_points;
+    route_points.reserve(stops.size());
+    for (size_t i = 0; i < stops.size(); ++i) {
+        auto [it, inserted] = prepared_stops.try_emplace(stops[i]);
+        if (inserted) {
+            it->second = geo::PrepareCoordinates(stops[i]->point);
+        }
+        route_points.emplace_back(it->second);
+        if (i > 0) {
+            bus.route_length += db.GetDistanceBetweenStops(stops[i - 1]->name, stops[i]->name);
+            if (route_type == RouteType::Pendulum) {
+                bus.route_length += db.GetDistanceBetweenStops(stops[i]->name, stops[i - 1]->name);
+            }
+        }
+    }
+    std::unordered_set<const Stop*> unique_stops(stops.begin(), stops.end());
+    double calc_route_length = geo::ComputeRouteDistance(route_points);
+
+    if (bus.route_type == RouteType::Pendulum && !stops.empty()) {
+        bus.final_stop = stops.back();
+        bus.route_stops_count = bus.route_stops_count * 2 - 1;
+        stops.reserve(bus.route_stops_count);
+        for (int i = bus.route_stops_count / 2 - 1; i >= 0; --i) {
+            stops.emplace_back(stops[i]);
+        }
+        calc_route_length *= 2;
+    }
+    bus.unique_stops_count = unique_stops.size();
+    bus.curvature = bus.route_length / calc_route_length;
+
+    return bus;
+}
+
+std::optional<Schedule> ParseSchedule(const Dict& request) {
+    const auto it = request.find("schedule"s);
+    if (it == request.end()) {
+        return std::nullopt;
+    }
+    const Dict& schedule = it->second.AsDict();
+    return Schedule{schedule.at("first_departure"s).AsDouble(),
+                    schedule.at("last_departure"s).AsDouble(),
+                    schedule.at("headway"s).AsDouble()};
+}
+
+// Число остановок маршрута из запроса Bus с учётом обратного направления маятникового маршрута
+size_t GetRouteStopsCount(const Dict& request) {
+    const size_t stops_count = request.at("stops"s).AsArray().size();
+    return request.at("is_roundtrip"s).AsBool() || stops_count == 0 ? stops_count : stops_count * 2 - 1;
+}
+
+// Остановки маршрута в том виде, в каком они заданы в запросе:
+// маятниковый маршрут хранится в справочнике уже развёрнутым в обе стороны
+std::vector<const Stop*> GetRequestStops(const Bus& bus) {
+    if (bus.route_type == RouteType::Pendulum && !bus.stops.empty()) {
+        return {bus.stops.begin(), bus.stops.begin() + bus.stops.size() / 2 + 1};
+    }
+    return {bus.stops.begin(), bus.stops.end()};
+}
+
+} // namespace
+
 void JsonReader::AddBuses(TransportCatalogue& db, const Array& base_requests,
     const std::vector<int> bus_request_ids) const {
 
+    PreparedStops prepared_stops;
+
     for (int id : bus_request_ids) {
         const auto& request = base_requests.at(id).AsDict();
-        Bus bus;
-        bus.number = request.at("name"s).AsString();
-        bus.route_type = request.at("is_roundtrip"s).AsBool() ? RouteType::Circular : RouteType::Pendulum;
-        bus.route_stops_count = 0;
-        bus.route_length = 0;
-        double calc_route_length = 0.0;
-
-        std::string prev_stop;
-        std::string curr_stop;  
-        std::unordered_set<const Stop*> unique_stops;
-        
-        const auto& stops = request.at("stops"s).AsArray();
-        for (const auto& stop : stops) {
-            prev_stop = std::move(curr_stop);
-            curr_stop = stop.AsString();
-            const Stop* bus_stop = db.FindStop(curr_stop);
-            bus.stops.emplace_back(bus_stop);
-            unique_stops.emplace(bus_stop);
-            if (bus.route_stops_count) {
-                calc_route_length += geo::ComputeDistance(
-                                    db.FindStop(prev_stop)->point,
-                                    db.FindStop(curr_stop)->point);
-                bus.route_length +=	db.GetDistanceBetweenStops(prev_stop, curr_stop);
-                if (bus.route_type == RouteType::Pendulum) {
-                    bus.route_length +=	db.GetDistanceBetweenStops(curr_stop, prev_stop);
-                }
-            }
-            ++bus.route_stops_count;
-        }
-        if (bus.route_type == RouteType::Pendulum) {
-            bus.final_stop = bus.stops.back();
-            bus.route_stops_count = bus.route_stops_count * 2 - 1;
-            std::vector<const Stop*> temp_stops(bus.stops);
-            for (int i = temp_stops.size() - 2; i >= 0; --i) {
-                bus.stops.emplace_back(temp_stops[i]);
-            }
-            calc_route_length *= 2;
-        }
-        bus.unique_stops_count = unique_stops.size();
-        bus.curvature = bus.route_length / calc_route_length;
-        std::string bus_number = bus.number;
-
-        db.AddBus(std::move(bus));
+        const auto& stop_names = request.at("stops"s).AsArray();
 
-        for (const auto& stop : unique_stops) {
-            db.AddBusThroughStop(stop, bus_number);
+        std::vector<const Stop*> stops;
+        stops.reserve(stop_names.size());
+        for (const auto& stop : stop_names) {
+            stops.emplace_back(db.FindStop(stop.AsString()));
         }
+
+        RouteType route_type = request.at("is_roundtrip"s).AsBool() ? RouteType::Circular : RouteType::Pendulum;
+        Bus bus = MakeBus(db, request.at("name"s).AsString(), route_type, stops, prepared_stops);
+        bus.schedule = ParseSchedule(request);
+        db.AddBus(std::move(bus), stops);
     }
 }
 
@@ -95,6 +142,20 @@ void JsonReader::UpdateTransportCatalogue(TransportCatalogue& db) const {
     std::vector<int> bus_request_ids;
     stop_with_distances_request_ids.reserve(base_requests.size());
     bus_request_ids.reserve(base_requests.size());
+
+    // Место в справочнике резервируется заранее, чтобы остановки и автобусы
+    // добавлялись без перемещений
+    size_t stops_count = 0;
+    size_t route_stops_count = 0;
+    for (const auto& node : base_requests) {
+        const auto& request = node.AsDict();
+        if (request.at("type"s) == "Stop"s) {
+            ++stops_count;
+        } else if (request.at("type"s) == "Bus"s) {
+            route_stops_count += GetRouteStopsCount(request);
+        }
+    }
+    db.Reserve(stops_count, base_requests.size() - stops_count, route_stops_count);
     
     for (size_t id = 0; id < base_requests.size(); ++id) {
         const auto& request = base_requests.at(id).AsDict();
@@ -113,6 +174,169 @@ void JsonReader::UpdateTransportCatalogue(TransportCatalogue& db) const {
     AddRoadDistances(db, base_requests, stop_with_distances_request_ids);
 
     AddBuses(db, base_requests, bus_request_ids);
+    db.BuildBusesThroughStops();
+}
+
+std::unordered_set<std::string_view> JsonReader::UpdateTransportCatalogue(const TransportCatalogue& old_db, TransportCatalogue& db) const {
+    const Dict& root = input_doc_.GetRoot().AsDict();
+
+    std::unordered_set<std::string_view> removed_stops;
+    std::unordered_set<std::string_view> removed_buses;
+    if (const auto it = root.find("removed_requests"s); it != root.end()) {
+        for (const auto& node : it->second.AsArray()) {
+            const auto& request = node.AsDict();
+            if (request.at("type"s) == "Stop"s) {
+                removed_stops.emplace(request.at("name"s).AsString());
+            } else if (request.at("type"s) == "Bus"s) {
+                removed_buses.emplace(request.at("name"s).AsString());
+            }
+        }
+    }
+
+    std::vector<const Dict*> stop_requests;
+    std::vector<const Dict*> bus_requests;
+    std::unordered_map<std::string_view, const Dict*> changed_stops;
+    std::unordered_set<std::string_view> changed_buses;
+    if (const auto it = root.find("base_requests"s); it != root.end()) {
+        for (const auto& node : it->second.AsArray()) {
+            const auto& request = node.AsDict();
+            if (request.at("type"s) == "Stop"s) {
+                stop_requests.emplace_back(&request);
+                changed_stops.emplace(request.at("name"s).AsString(), &request);
+            } else if (request.at("type"s) == "Bus"s) {
+                bus_requests.emplace_back(&request);
+                changed_buses.emplace(request.at("name"s).AsString());
+            }
+        }
+    }
+
+    const auto& old_stops = old_db.GetAllRawStops();
+    const auto& old_buses = old_db.GetAllRawBuses();
+    size_t route_stops_count = 0;
+    for (const Bus& old_bus : old_buses) {
+        route_stops_count += old_bus.stops.size();
+    }
+    for (const Dict* request : bus_requests) {
+        route_stops_count += GetRouteStopsCount(*request);
+    }
+    db.Reserve(old_stops.size() + stop_requests.size(), old_buses.size() + bus_requests.size(), route_stops_count);
+
+    // Остановки переносятся в порядке их добавления в старую базу
+    std::unordered_set<const Stop*> moved_stops;
+    for (const Stop& old_stop : old_stops) {
+        if (removed_stops.count(old_stop.name) || changed_stops.count(old_stop.name)) {
+            continue;
+        }
+        db.AddStop(old_stop);
+    }
+    for (const Dict* request : stop_requests) {
+        auto [stop, has_road_distances] = ParseStopRequest(*request);
+        const Stop* old_stop = old_db.FindStop(stop.name);
+        bool is_moved = old_stop != nullptr && old_stop->point != stop.point;
+        const std::string_view name = stop.name;
+        db.AddStop(std::move(stop));
+        if (is_moved) {
+            moved_stops.emplace(db.FindStop(name));
+        }
+    }
+
+    // Расстояния из запросов-дельт заменяют расстояния старой базы
+    // между теми же остановками в том же направлении
+    std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, detail::PairHash> distances;
+    std::unordered_set<const Stop*> distance_stops;
+    for (const auto& [from_to, distance] : old_db.GetDistancesBetweenStops()) {
+        const Stop* from = db.FindStop(from_to.first->name);
+        const Stop* to = db.FindStop(from_to.second->name);
+        if (from != nullptr && to != nullptr) {
+            distances.emplace(std::pair(from, to), distance);
+        }
+    }
+    for (const Dict* request : stop_requests) {
+        const Stop* from = db.FindStop(request->at("name"s).AsString());
+        for (const auto& [stop_to, distance] : request->at("road_distances"s).AsDict()) {
+            const Stop* to = db.FindStop(stop_to);
+            if (to == nullptr) {
+                throw std::logic_error("Unknown stop '"s + stop_to + "' in road_distances"s);
+            }
+            distances[std::pair(from, to)] = distance.AsInt();
+            distance_stops.emplace(from);
+            distance_stops.emplace(to);
+        }
+    }
+    for (const auto& [from_to, distance] : distances) {
+        db.AddDistanceBetweenStops(from_to.first->name, distance, from_to.second->name);
+    }
+
+    // Автобусы, маршруты которых не изменились, переносятся со старыми характеристиками.
+    // Если у остановки маршрута сменились координаты, пересчитывается только извилистость,
+    // а если сменились расстояния — ещё и рёбра автобуса в графе маршрутизации
+    std::unordered_set<std::string_view> rebuilt_buses;
+    PreparedStops prepared_stops;
+    for (const Bus& old_bus : old_buses) {
+        if (removed_buses.count(old_bus.number) || changed_buses.count(old_bus.number)) {
+            continue;
+        }
+        bool is_changed = false;
+        bool is_rebuilt = false;
+        std::vector<const Stop*> stops;
+        stops.reserve(old_bus.stops.size());
+        for (const Stop* old_stop : GetRequestStops(old_bus)) {
+            const Stop* stop = db.FindStop(old_stop->name);
+            if (stop == nullptr) {
+                throw std::logic_error("Stop '"s + std::string(old_stop->name) + "' is removed but bus '"s
+                                       + std::string(old_bus.number) + "' still uses it"s);
+            }
+            is_changed = is_changed || moved_stops.count(stop) || distance_stops.count(stop);
+            is_rebuilt = is_rebuilt || distance_stops.count(stop);
+            stops.emplace_back(stop);
+        }
+        if (is_changed) {
+            Bus bus = MakeBus(db, old_bus.number, old_bus.route_type, stops, prepared_stops);
+            bus.schedule = old_bus.schedule;
+            db.AddBus(std::move(bus), stops);
+        } else {
+            Bus bus = old_bus;
+            stops.clear();
+            for (const Stop* stop : old_bus.stops) {
+                stops.emplace_back(db.FindStop(stop->name));
+            }
+            if (bus.final_stop != nullptr) {
+                bus.final_stop = db.FindStop(bus.final_stop->name);
+            }
+            db.AddBus(std::move(bus), stops);
+        }
+        if (is_rebuilt) {
+            rebuilt_buses.emplace(db.GetAllRawBuses().back().number);
+        }
+    }
+    for (const Dict* request : bus_requests) {
+        const auto& stop_names = request->at("stops"s).AsArray();
+        std::vector<const Stop*> stops;
+        stops.reserve(stop_names.size());
+        for (const auto& stop : stop_names) {
+            const Stop* bus_stop = db.FindStop(stop.AsString());
+            if (bus_stop == nullptr) {
+                throw std::logic_error("Unknown stop '"s + stop.AsString() + "' in bus stops"s);
+            }
+            stops.emplace_back(bus_stop);
+        }
+        RouteType route_type = request->at("is_roundtrip"s).AsBool() ? RouteType::Circular : RouteType::Pendulum;
+        Bus bus = MakeBus(db, request->at("name"s).AsString(), route_type, stops, prepared_stops);
+        bus.schedule = ParseSchedule(*request);
+        db.AddBus(std::move(bus), stops);
+        rebuilt_buses.emplace(db.GetAllRawBuses().back().number);
+    }
+    db.BuildBusesThroughStops();
+
+    return rebuilt_buses;
+}
+
+bool JsonReader::HasRenderSettings() const {
+    return input_doc_.GetRoot().AsDict().count("render_settings"s) > 0;
+}
+
+bool JsonReader::HasRoutingSettings() const {
+    return input_doc_.GetRoot().AsDict().count("routing_settings"s) > 0;
 }
 
 void JsonReader::UpdateMapRenderer(renderer::MapRenderer& renderer) const {
@@ -167,6 +391,27 @@ void JsonReader::UpdateMapRenderer(renderer::MapRenderer& renderer) const {
         }
     }
 
+    if (const auto number_format = render_settings.find("number_format"sv); number_format != render_settings.end()) {
+        const std::string& name = number_format->second.AsString();
+        if (name == "to_chars"s) {
+            settings.number_format = svg::NumberFormat::ToChars;
+        } else if (name == "stream"s) {
+            settings.number_format = svg::NumberFormat::Stream;
+        } else {
+            throw std::invalid_argument("unknown number_format: "s + name);
+        }
+    }
+
+    if (const auto level_of_detail = render_settings.find("level_of_detail"sv); level_of_detail != render_settings.end()) {
+        settings.level_of_detail = level_of_detail->second.AsBool();
+    }
+    if (const auto lod_tolerance = render_settings.find("lod_tolerance"sv); lod_tolerance != render_settings.end()) {
+        if (lod_tolerance->second.AsDouble() < 0.0) {
+            throw std::logic_error("lod_tolerance must not be negative"s);
+        }
+        settings.lod_tolerance = lod_tolerance->second.AsDouble();
+    }
+
     renderer.SetRenderSettings(std::move(settings));
     //renderer.PrintRenderSettings();
 }
@@ -190,72 +435,183 @@ JsonReader::Path JsonReader::GetSerializationSettings() const {
     return path;
 }
 
+std::optional<compression::Settings> JsonReader::GetCompressionSettings() const {
+    const auto& serialization_settings = input_doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict();
+
+    const auto codec = serialization_settings.find("compression"s);
+    if (codec == serialization_settings.end()) {
+        return std::nullopt;
+    }
+    compression::Settings settings;
+    settings.codec = compression::ParseCodec(codec->second.AsString());
+    if (const auto level = serialization_settings.find("compression_level"s); level != serialization_settings.end()) {
+        settings.level = level->second.AsInt();
+    }
+    if (const auto block_size = serialization_settings.find("block_size"s); block_size != serialization_settings.end()) {
+        if (block_size->second.AsInt() <= 0) {
+            throw std::logic_error("block_size must be positive"s);
+        }
+        settings.block_size = static_cast<size_t>(block_size->second.AsInt());
+    }
+    return settings;
+}
+
+JsonReader::Path JsonReader::GetUpdatedSerializationSettings() const {
+    const auto& serialization_settings = input_doc_.GetRoot().AsDict().at("serialization_settings").AsDict();
+
+    const auto it = serialization_settings.find("output_file");
+    Path path = (it != serialization_settings.end() ? it->second : serialization_settings.at("file")).AsString();
+
+    return path;
+}
+
+namespace {
+
+RequestType ParseRequestType(std::string_view type) {
+    if (type == "Bus"sv) {
+        return RequestType::Bus;
+    } else if (type == "Stop"sv) {
+        return RequestType::Stop;
+    } else if (type == "Map"sv) {
+        return RequestType::Map;
+    } else if (type == "Route"sv) {
+        return RequestType::Route;
+    } else if (type == "RouteOptions"sv) {
+        return RequestType::RouteOptions;
+    }
+    return RequestType::Unknown;
+}
+
+// Аналог Dict::at, который ищет ключ без создания временной строки
+const Node& GetField(const Dict& dict, std::string_view key) {
+    const auto it = dict.find(key);
+    if (it == dict.end()) {
+        throw std::out_of_range("missing key '"s + std::string(key) + "'"s);
+    }
+    return it->second;
+}
+
+// Ответ "not found" отличается от запроса к запросу только request_id, поэтому текст
+// вокруг него сериализуется один раз, и ответ не выделяет памяти
+json::Fragment MakeNotFound(int request_id) {
+    static const std::pair<std::string, std::string> text
+        = json::PrintFragment(Dict{{"error_message"s, "not found"s}}, "request_id"s);
+    return json::Fragment{text.first, request_id, text.second};
+}
+
+// Ответ из request_id и поля key. Список инициализации Dict копирует свои элементы,
+// а здесь значение переносится: так ответ не дублирует SVG карты и длинные маршруты
+Dict MakeResponse(int request_id, std::string key, Node value) {
+    Dict response;
+    response.emplace("request_id"s, request_id);
+    response.emplace(std::move(key), std::move(value));
+    return response;
+}
+
+} // namespace
+
+Node JsonReader::ProcessStatRequest(const Dict& request, RequestHandler& request_handler) const {
+    const int request_id = GetField(request, "id"sv).AsInt();
+    const std::string_view type_name = GetField(request, "type"sv).AsString();
+    const RequestType type = ParseRequestType(type_name);
+    stats::ScopedRequest request_stats(type_name);
+
+    const TransportCatalogue& db = request_handler.GetTransportCatalogue();
+
+    switch (type) {
+    case RequestType::Bus: {
+        const Bus* bus = db.FindBus(GetField(request, "name"sv).AsString());
+        if (bus == nullptr) {
+            return MakeNotFound(request_id);
+        }
+        // Обычно в базе уже есть готовый ответ, в который остаётся подставить только request_id
+        if (const StatResponse* stat_response = db.GetStatResponse(bus)) {
+            return json::Fragment{stat_response->prefix, request_id, stat_response->suffix};
+        }
+        Dict response = request_handler.GetBusStat(*bus);
+        response.emplace("request_id"s, request_id);
+        return response;
+    }
+    case RequestType::Stop: {
+        const Stop* stop = db.FindStop(GetField(request, "name"sv).AsString());
+        if (stop == nullptr) {
+            return MakeNotFound(request_id);
+        }
+        if (const StatResponse* stat_response = db.GetStatResponse(stop)) {
+            return json::Fragment{stat_response->prefix, request_id, stat_response->suffix};
+        }
+        Dict response = request_handler.GetStopStat(*stop);
+        response.emplace("request_id"s, request_id);
+        return response;
+    }
+    case RequestType::Map: {
+        std::ostringstream strm;
+        request_handler.RenderMap(strm);
+        return MakeResponse(request_id, "map"s, strm.str());
+    }
+    case RequestType::Route: {
+        const Stop* stop_from = db.FindStop(GetField(request, "from"sv).AsString());
+        const Stop* stop_to = db.FindStop(GetField(request, "to"sv).AsString());
+        if (stop_from == nullptr || stop_to == nullptr) {
+            return MakeNotFound(request_id);
+        }
+        if (const auto departure_time = request.find("departure_time"sv); departure_time != request.end()) {
+            if (auto timetable_route = request_handler.BuildRoute(stop_from, stop_to, departure_time->second.AsDouble())) {
+                Dict response = MakeResponse(request_id, "items"s, request_handler.GetLegsItems(timetable_route->legs));
+                response.emplace("total_time"s, timetable_route->total_time);
+                return response;
+            }
+        } else if (auto builded_router = request_handler.BuildRoute(stop_from, stop_to)) {
+            Dict response = MakeResponse(request_id, "items"s, request_handler.GetEdgesItems(builded_router->edges));
+            response.emplace("total_time"s, builded_router->weight);
+            return response;
+        }
+        return MakeNotFound(request_id);
+    }
+    case RequestType::RouteOptions: {
+        const Stop* stop_from = db.FindStop(GetField(request, "from"sv).AsString());
+        const Stop* stop_to = db.FindStop(GetField(request, "to"sv).AsString());
+        auto journeys = stop_from != nullptr && stop_to != nullptr
+                      ? request_handler.BuildRouteOptions(stop_from, stop_to)
+                      : std::vector<router::RaptorRouter::Journey>{};
+        if (journeys.empty()) {
+            return MakeNotFound(request_id);
+        }
+        Array options;
+        options.reserve(journeys.size());
+        for (const auto& journey : journeys) {
+            Dict option;
+            option.emplace("items"s, request_handler.GetLegsItems(journey.legs));
+            option.emplace("total_time"s, journey.total_time);
+            option.emplace("transfers"s, static_cast<int>(journey.transfers));
+            options.emplace_back(std::move(option));
+        }
+        return MakeResponse(request_id, "options"s, std::move(options));
+    }
+    case RequestType::Unknown:
+        break;
+    }
+    return Dict{{"request_id"s, request_id}};
+}
+
 Node JsonReader::ProcessStatRequests(RequestHandler& request_handler) const {
-    const Array& stat_requests = input_doc_.GetRoot().AsDict().at("stat_requests"s).AsArray();
+    const Array& stat_requests = GetField(input_doc_.GetRoot().AsDict(), "stat_requests"sv).AsArray();
     Array responses;
     responses.reserve(stat_requests.size());
 
     for (const auto& stat_request : stat_requests) {
-        const auto& request = stat_request.AsDict();
-        Dict response;
-        response.emplace("request_id"s, request.at("id"s).AsInt());
-        std::string type = request.at("type"s).AsString();
-        
-        if (type == "Bus"s) {
-            std::string name = request.at("name"s).AsString();
-            const Bus* bus = request_handler.GetTransportCatalogue().FindBus(name);
-            if (bus != nullptr) {
-                auto [route_stops_count, unique_stops_count, route_length, curvature] = request_handler.GetTransportCatalogue().GetRouteInfo(bus);
-                response.emplace("curvature"s, curvature);
-                response.emplace("route_length"s, static_cast<int>(route_length));
-                response.emplace("stop_count"s, static_cast<int>(route_stops_count));
-                response.emplace("unique_stop_count"s, static_cast<int>(unique_stops_count));
-            } else {
-                response.emplace("error_message"s, "not found"s);  
-            }
-        } else if (type == "Stop"s) {
-            std::string name = request.at("name"s).AsString();
-            const Stop* stop = request_handler.GetTransportCatalogue().FindStop(name);
-            if (stop != nullptr) {
-                Array buses;
-                const auto buses_through_stop = request_handler.GetTransportCatalogue().GetBusesThroughStop(stop);
-                if (buses_through_stop != nullptr) {
-                    buses.reserve(buses_through_stop->size());
-                    for (const auto& bus : *buses_through_stop) {
-                        buses.emplace_back(bus->number);
-                    }
-                }
-                response.emplace("buses"s, std::move(buses));
-            } else {
-                response.emplace("error_message"s, "not found"s);  
-            }
-        } else if (type == "Map"s) {
-            std::ostringstream strm;
-            request_handler.RenderMap().Render(strm);
-            response.emplace("map"s, std::move(strm.str()));
-        } else if (type == "Route"s) {
-            std::string from_stop_name = request.at("from"s).AsString();
-            std::string to_stop_name = request.at("to"s).AsString();
-            if (const Stop* stop_from = request_handler.GetTransportCatalogue().FindStop(from_stop_name)) {
-                if (const Stop* stop_to = request_handler.GetTransportCatalogue().FindStop(to_stop_name)) {
-                    if (auto builded_router = request_handler.BuildRoute(stop_from, stop_to)) {
-                        auto [weight, edges] = builded_router.value();
-                        response.emplace("total_time"s, std::move(weight));
-                        response.emplace("items"s, request_handler.GetEdgesItems(edges));
-                    } else {
-                        response.emplace("error_message"s, "not found"s);
-                    }
-                } else {
-                    response.emplace("error_message"s, "not found"s);
-                }
-            } else {
-                response.emplace("error_message"s, "not found"s);
-            }
-        }
-        responses.emplace_back(response);
+        responses.emplace_back(ProcessStatRequest(stat_request.AsDict(), request_handler));
+    }
+    return responses;
+}
+
+void JsonReader::ProcessStatRequests(RequestHandler& request_handler, std::ostream& output) const {
+    const Array& stat_requests = GetField(input_doc_.GetRoot().AsDict(), "stat_requests"sv).AsArray();
+    json::ArrayWriter writer(output);
+    for (const auto& stat_request : stat_requests) {
+        writer.Write(ProcessStatRequest(stat_request.AsDict(), request_handler));
     }
-    return json::Builder{}.Value(std::move(responses)).Build();
-    // return responses;
+    writer.Finish();
 }
 
 } // namespace transport_catalogue
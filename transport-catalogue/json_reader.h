@@ -1,5 +1,6 @@
 #pragma once
 
+#include "compression.h"
 #include "json.h"
 #include "transport_catalogue.h"
 #include "map_renderer.h"
@@ -7,11 +8,23 @@
 #include "transport_router.h"
 
 #include <filesystem>
+#include <string>
+#include <unordered_set>
 
 namespace transport_catalogue {
 
 using namespace json;
 
+// Тип запроса stat_requests
+enum class RequestType {
+    Bus,
+    Stop,
+    Map,
+    Route,
+    RouteOptions,
+    Unknown
+};
+
 class JsonReader {
 public:
     using Path = std::filesystem::path;
@@ -22,14 +35,42 @@ public:
 
     void UpdateTransportCatalogue(TransportCatalogue& db) const;
 
+    // Заполняет db содержимым базы old_db с изменениями из документа-дельты:
+    // base_requests задают добавленные или изменённые остановки и автобусы,
+    // removed_requests — удалённые. Возвращает номера автобусов, рёбра которых
+    // в графе маршрутизации нужно построить заново (строки из пула названий db)
+    std::unordered_set<std::string_view> UpdateTransportCatalogue(const TransportCatalogue& old_db, TransportCatalogue& db) const;
+
+    bool HasRenderSettings() const;
+
+    bool HasRoutingSettings() const;
+
     void UpdateMapRenderer(renderer::MapRenderer& renderer) const;
     
     void UpdateRouter(router::Router& router) const;
 
     Path GetSerializationSettings() const;
 
+    // Сжатие файла базы: поля compression (none, zlib, zstd, lz4), compression_level
+    // и block_size из serialization_settings. Если compression не задано,
+    // база записывается одним несжатым сообщением, как раньше
+    std::optional<compression::Settings> GetCompressionSettings() const;
+
+    // Файл, в который записывается обновлённая база: output_file,
+    // а если он не задан — file из serialization_settings
+    Path GetUpdatedSerializationSettings() const;
+
     Node ProcessStatRequests(RequestHandler& request_handler) const;
 
+    // Выводит в output ответ на каждый запрос сразу после его обработки, в том же виде,
+    // что и json::Print результата ProcessStatRequests. Одновременно в памяти
+    // находится не больше одного ответа
+    void ProcessStatRequests(RequestHandler& request_handler, std::ostream& output) const;
+
+    // Ответ на один запрос из stat_requests. Запросы Bus и Stop, для которых в базе
+    // есть готовый ответ, обрабатываются без выделений памяти
+    Node ProcessStatRequest(const Dict& request, RequestHandler& request_handler) const;
+
     Node ProcessStatRequests(TransportCatalogue& db) const;
 
 private:
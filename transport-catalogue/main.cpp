@@ -5,9 +5,9 @@
 #include "map_renderer.h"
 #include "transport_router.h"
 #include "serialization.h"
-
-//#include "input_reader.h"
-//#include "stat_reader.h"
+#include "stats.h"
+#include "input_reader.h"
+#include "mapped_file.h"
 
 #include <iostream>
 #include <fstream>
@@ -17,20 +17,66 @@
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests] [--stats[=FILE]]\n"sv
+           << "       transport_catalogue make_base --format=text --settings=FILE [--stats[=FILE]]\n"sv
+           << "       transport_catalogue process_requests --stream [--stats[=FILE]]\n"sv;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    if (argc < 2) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
 
+    // --stats выводит отчёт о времени и памяти по этапам в stderr, --stats=FILE — в файл.
+    // --format=text: make_base читает остановки и автобусы в текстовом формате input_reader,
+    // а serialization_settings, routing_settings и render_settings — из JSON-файла --settings.
+    // --stream: process_requests выводит каждый ответ сразу после обработки запроса
+    std::filesystem::path stats_path;
+    std::string_view format = "json"sv;
+    std::filesystem::path settings_path;
+    bool is_streaming = false;
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view option(argv[i]);
+        if (option == "--stats"sv) {
+            stats::Enable();
+        } else if (option.substr(0, "--stats="sv.size()) == "--stats="sv) {
+            stats::Enable();
+            stats_path = option.substr("--stats="sv.size());
+        } else if (option.substr(0, "--format="sv.size()) == "--format="sv) {
+            format = option.substr("--format="sv.size());
+        } else if (option.substr(0, "--settings="sv.size()) == "--settings="sv) {
+            settings_path = option.substr("--settings="sv.size());
+        } else if (option == "--stream"sv) {
+            is_streaming = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    const bool is_text_format = format == "text"sv;
+    if ((format != "json"sv && !is_text_format) || (is_text_format && (mode != "make_base"sv || settings_path.empty()))
+        || (is_streaming && mode != "process_requests"sv)) {
+        PrintUsage();
+        return 1;
+    }
+
     using namespace transport_catalogue;
 
-    const json::Document input_doc = json::Load(std::cin);
+    const json::Document input_doc = [&] {
+        stats::ScopedStage stage("parse"sv);
+        if (is_text_format) {
+            std::ifstream settings(settings_path);
+            if (!settings) {
+                throw std::runtime_error("cannot open "s + settings_path.string());
+            }
+            return json::Load(settings);
+        }
+        return json::Load(std::cin);
+    }();
     //json::Print(input_doc, cout);
 
     JsonReader json_reader(input_doc);
@@ -43,28 +89,101 @@ int main(int argc, char* argv[]) {
 
     if (mode == "make_base"sv) {
 
-        json_reader.UpdateTransportCatalogue(db);
+        {
+            stats::ScopedStage stage("build_catalogue"sv);
+            if (is_text_format) {
+                // Перенаправленный из файла ввод отображается в память без копирования
+                const mapped_file::MappedFile input(0);
+                input_queries_utils::LoadTransportCatalogue(db, input.GetData());
+            } else {
+                json_reader.UpdateTransportCatalogue(db);
+            }
         
-        json_reader.UpdateMapRenderer(renderer);
+            json_reader.UpdateMapRenderer(renderer);
         
-        json_reader.UpdateRouter(router);
+            json_reader.UpdateRouter(router);
+        }
 
-        router.BuildGraph(db);
+        {
+            stats::ScopedStage stage("build_graph"sv);
+            router.BuildGraph(db);
+        }
 
+        stats::ScopedStage stage("serialize"sv);
+        serialization.SetCompressionSettings(json_reader.GetCompressionSettings());
         serialization.SerializeDataBase();
 
-    } else if (mode == "process_requests"sv) {
+    } else if (mode == "update_base"sv) {
+
+        {
+            stats::ScopedStage stage("deserialize"sv);
+            serialization.DeserializeDataBase();
+        }
+
+        TransportCatalogue updated_db;
+        router::Router updated_router(updated_db);
+
+        std::unordered_set<std::string_view> rebuilt_buses;
+        {
+            stats::ScopedStage stage("update_catalogue"sv);
+            rebuilt_buses = json_reader.UpdateTransportCatalogue(db, updated_db);
+
+            if (json_reader.HasRenderSettings()) {
+                json_reader.UpdateMapRenderer(renderer);
+            }
+        }
+
+        {
+            stats::ScopedStage stage("update_graph"sv);
+            if (json_reader.HasRoutingSettings()) {
+                json_reader.UpdateRouter(updated_router);
+                updated_router.BuildGraph(updated_db);
+            } else {
+                updated_router.SetRoutingSettings(router.GetRoutingSettings());
+                updated_router.UpdateGraph(updated_db, router, rebuilt_buses);
+            }
+        }
+
+        stats::ScopedStage stage("serialize"sv);
+        serialization::Serialization updated_serialization(updated_db, renderer, updated_router,
+                                                           json_reader.GetUpdatedSerializationSettings());
+        updated_serialization.SetCompressionSettings(json_reader.GetCompressionSettings());
+        updated_serialization.SerializeDataBase();
 
-        serialization.DeserializeDataBase();
-        
-        RequestHandler request_handler(db, renderer, router);
-        
-        auto response = json_reader.ProcessStatRequests(request_handler);
+    } else if (mode == "process_requests"sv) {
 
-        json::Print(Document{std::move(response)}, std::cout);
+        {
+            stats::ScopedStage stage("deserialize"sv);
+            serialization.DeserializeDataBase();
+        }
+
+        // Граф и таблица маршрутов строятся при первом запросе Route,
+        // настройки визуализации — при первом запросе Map. Потоки пула
+        // создаются один раз и используются всеми запросами Map
+        thread_pool::ThreadPool pool;
+        RequestHandler request_handler(db, renderer, router, &pool);
+
+        if (is_streaming) {
+            stats::ScopedStage stage("process_requests"sv);
+            json_reader.ProcessStatRequests(request_handler, std::cout);
+            std::cout.flush();
+        } else {
+            Node response;
+            {
+                stats::ScopedStage stage("process_requests"sv);
+                response = json_reader.ProcessStatRequests(request_handler);
+            }
+
+            stats::ScopedStage stage("print"sv);
+            json::Print(Document{std::move(response)}, std::cout);
+        }
 
     } else {
         PrintUsage();
         return 1;
     }
+
+    if (stats::IsEnabled()) {
+        stats::PrintReport(stats_path);
+    }
 }
@@ -1,9 +1,143 @@
 #include "map_renderer.h"
 
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
 namespace renderer {
 
 using namespace std::literals;
 
+namespace {
+
+// Расстояние от точки p до отрезка ab
+double DistanceToSegment(svg::Point p, svg::Point a, svg::Point b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length_sq = dx * dx + dy * dy;
+    double t = 0.0;
+    if (length_sq > 0.0) {
+        t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length_sq, 0.0, 1.0);
+    }
+    return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+// Упрощает ломаную алгоритмом Дугласа — Пекера: отбрасывает точки, отклоняющиеся
+// от упрощённой линии не больше чем на tolerance. Концы ломаной сохраняются
+std::vector<svg::Point> SimplifyPolyline(const std::vector<svg::Point>& points, double tolerance) {
+    if (points.size() < 3) {
+        return points;
+    }
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+
+    // Участки обрабатываются через стек, а не рекурсией: маршрут может быть очень длинным
+    std::vector<std::pair<size_t, size_t>> ranges{{0, points.size() - 1}};
+    while (!ranges.empty()) {
+        const auto [first, last] = ranges.back();
+        ranges.pop_back();
+
+        double max_distance = tolerance;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            const double distance = DistanceToSegment(points[i], points[first], points[last]);
+            if (distance > max_distance) {
+                max_distance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest != first) {
+            keep[farthest] = true;
+            ranges.emplace_back(first, farthest);
+            ranges.emplace_back(farthest, last);
+        }
+    }
+
+    std::vector<svg::Point> result;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) {
+            result.push_back(points[i]);
+        }
+    }
+    return result;
+}
+
+// Прямоугольник на экране: left <= x < right, top <= y < bottom
+struct Box {
+    double left = 0.0;
+    double top = 0.0;
+    double right = 0.0;
+    double bottom = 0.0;
+};
+
+bool Intersects(const Box& lhs, const Box& rhs) {
+    return lhs.left < rhs.right && rhs.left < lhs.right && lhs.top < rhs.bottom && rhs.top < lhs.bottom;
+}
+
+// Приблизительные границы надписи text размером font_size с опорной точкой position:
+// ширина символа принимается равной 0.6 кегля, символы считаются в UTF-8
+Box GetLabelBox(svg::Point position, std::string_view text, int font_size) {
+    size_t chars_count = 0;
+    for (const char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+            ++chars_count;
+        }
+    }
+    return {position.x, position.y - font_size,
+            position.x + 0.6 * font_size * static_cast<double>(chars_count), position.y};
+}
+
+// Размещённые надписи, разложенные по ячейкам равномерной сетки: надпись проверяется
+// только с теми, что попали в те же ячейки
+class LabelGrid {
+public:
+    explicit LabelGrid(double cell_size)
+        : cell_size_(std::max(cell_size, 1.0)) {
+    }
+
+    // Размещает надпись, если она не перекрывает размещённые ранее
+    bool TryPlace(const Box& box) {
+        const auto [left, top] = GetCell(box.left, box.top);
+        const auto [right, bottom] = GetCell(box.right, box.bottom);
+        for (int64_t x = left; x <= right; ++x) {
+            for (int64_t y = top; y <= bottom; ++y) {
+                const auto cell = cells_.find(GetKey(x, y));
+                if (cell == cells_.end()) {
+                    continue;
+                }
+                for (const size_t index : cell->second) {
+                    if (Intersects(box, boxes_[index])) {
+                        return false;
+                    }
+                }
+            }
+        }
+        for (int64_t x = left; x <= right; ++x) {
+            for (int64_t y = top; y <= bottom; ++y) {
+                cells_[GetKey(x, y)].push_back(boxes_.size());
+            }
+        }
+        boxes_.push_back(box);
+        return true;
+    }
+
+private:
+    std::pair<int64_t, int64_t> GetCell(double x, double y) const {
+        return {static_cast<int64_t>(std::floor(x / cell_size_)), static_cast<int64_t>(std::floor(y / cell_size_))};
+    }
+
+    static uint64_t GetKey(int64_t x, int64_t y) {
+        return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+    }
+
+    double cell_size_;
+    std::vector<Box> boxes_;
+    std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+};
+
+} // namespace
+
 
 bool IsZero(double value) {
     return std::abs(value) < EPSILON;
@@ -17,14 +151,30 @@ svg::Point SphereProjector::operator()(geo::Coordinates coords) const {
 }
 
 void MapRenderer::SetRenderSettings(RenderSettings settings) {
+    render_settings_loader_ = nullptr;
     render_settings_ = std::move(settings);
 }
 
+void MapRenderer::SetRenderSettingsLoader(std::function<RenderSettings()> loader) {
+    render_settings_loader_ = std::move(loader);
+}
+
+void MapRenderer::LoadRenderSettings() const {
+    std::call_once(render_settings_flag_, [this] {
+        if (render_settings_loader_) {
+            render_settings_ = render_settings_loader_();
+            render_settings_loader_ = nullptr;
+        }
+    });
+}
+
 const RenderSettings& MapRenderer::GetRenderSettings() const {
+    LoadRenderSettings();
     return render_settings_;
 }
 
 void MapRenderer::PrintRenderSettings() const {
+    LoadRenderSettings();
 
     std::cout << "width = "s << render_settings_.width << std::endl;
     std::cout << "height = "s << render_settings_.height << std::endl;
@@ -43,6 +193,10 @@ void MapRenderer::PrintRenderSettings() const {
     std::cout << "underlayer_color = "s << render_settings_.underlayer_color << std::endl;
     std::cout << "-----------------------------------------------------------"s << std::endl;
     std::cout << "underlayer_width = "s << render_settings_.underlayer_width << std::endl;
+    std::cout << "number_format = "s
+              << (render_settings_.number_format == svg::NumberFormat::ToChars ? "to_chars"s : "stream"s) << std::endl;
+    std::cout << "level_of_detail = "s << render_settings_.level_of_detail
+              << ", lod_tolerance = "s << render_settings_.lod_tolerance << std::endl;
     std::cout << "-----------------------------------------------------------"s << std::endl;
     std::cout << "color_palette first color = "s << render_settings_.color_palette[0] << std::endl;
     std::cout << "color_palette second color = "s << render_settings_.color_palette[1] << std::endl;
@@ -50,11 +204,26 @@ void MapRenderer::PrintRenderSettings() const {
 }
 
 svg::Polyline MapRenderer::GetBusRoute(const domain::Bus* bus, const SphereProjector& proj, size_t color_number) const {
+    LoadRenderSettings();
 
     svg::Polyline result;
-        
-    for (const auto& stop : bus->stops) {
-        result.AddPoint(proj(stop->point));
+
+    if (!render_settings_.level_of_detail) {
+        for (const auto& stop : bus->stops) {
+            result.AddPoint(proj(stop->point));
+        }
+    } else {
+        // Маятниковый маршрут в обратную сторону проходит по тем же точкам
+        const size_t stops_count = bus->route_type == domain::RouteType::Pendulum && !bus->stops.empty()
+                                 ? bus->stops.size() / 2 + 1 : bus->stops.size();
+        std::vector<svg::Point> points;
+        points.reserve(stops_count);
+        for (size_t i = 0; i < stops_count; ++i) {
+            points.push_back(proj(bus->stops[i]->point));
+        }
+        for (const svg::Point& point : SimplifyPolyline(points, render_settings_.lod_tolerance)) {
+            result.AddPoint(point);
+        }
     }
 
     result.SetFillColor("none"s);
@@ -67,29 +236,27 @@ svg::Polyline MapRenderer::GetBusRoute(const domain::Bus* bus, const SphereProje
 }
 
 std::vector<svg::Text> MapRenderer::GetBusTitle(const domain::Bus* bus, const SphereProjector& proj, size_t color_number) const {
+    LoadRenderSettings();
 
     std::vector<svg::Text> result;
-    svg::Text text_underlayer;
-    svg::Text text_title;
-    
-    svg::Point start_point = proj(bus->stops[0]->point);
-    text_underlayer.SetPosition(start_point);
-    text_title.SetPosition(start_point);
-    text_underlayer.SetOffset(render_settings_.bus_label_offset);
-    text_title.SetOffset(render_settings_.bus_label_offset);
-    text_underlayer.SetFontSize(render_settings_.bus_label_font_size);
-    text_title.SetFontSize(render_settings_.bus_label_font_size);
-    text_underlayer.SetFontFamily("Verdana"s);
-    text_title.SetFontFamily("Verdana"s);
-    text_underlayer.SetFontWeight("bold"s);
-    text_title.SetFontWeight("bold"s);
-    text_underlayer.SetData(bus->number);
-    text_title.SetData(bus->number);
+
+    // Общие свойства подложки и надписи, в том числе текст, который экранируется
+    // при задании, задаются один раз, после чего объект копируется
+    svg::Text text;
+    text.SetPosition(proj(bus->stops[0]->point));
+    text.SetOffset(render_settings_.bus_label_offset);
+    text.SetFontSize(render_settings_.bus_label_font_size);
+    text.SetFontFamily("Verdana"s);
+    text.SetFontWeight("bold"s);
+    text.SetData(std::string(bus->number));
+
+    svg::Text text_underlayer = text;
     text_underlayer.SetFillColor(render_settings_.underlayer_color);
     text_underlayer.SetStrokeColor(render_settings_.underlayer_color);
     text_underlayer.SetStrokeWidth(render_settings_.underlayer_width);
     text_underlayer.SetStrokeLineCap(svg::StrokeLineCap::ROUND);
     text_underlayer.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
+    svg::Text text_title = std::move(text);
     text_title.SetFillColor(render_settings_.color_palette[color_number]);
 
     if ((bus->route_type == domain::RouteType::Pendulum) && (bus->final_stop) && (bus->final_stop->name != bus->stops[0]->name)) {
@@ -98,8 +265,6 @@ std::vector<svg::Text> MapRenderer::GetBusTitle(const domain::Bus* bus, const Sp
         svg::Point final_point = proj(bus->final_stop->point);
         text_final_underlayer.SetPosition(final_point);
         text_final_title.SetPosition(final_point);
-        text_final_underlayer.SetData(bus->number);
-        text_final_title.SetData(bus->number);
         result.emplace_back(std::move(text_underlayer));
         result.emplace_back(std::move(text_title));
         result.emplace_back(std::move(text_final_underlayer));
@@ -112,6 +277,7 @@ std::vector<svg::Text> MapRenderer::GetBusTitle(const domain::Bus* bus, const Sp
 }
 
 svg::Circle MapRenderer::GetStopCircle(const domain::Stop* stop, const SphereProjector& proj) const {
+    LoadRenderSettings();
 
     svg::Circle result;
         
@@ -123,27 +289,24 @@ svg::Circle MapRenderer::GetStopCircle(const domain::Stop* stop, const SpherePro
 }
 
 std::vector<svg::Text> MapRenderer::GetStopTitle(const domain::Stop* stop, const SphereProjector& proj) const {
+    LoadRenderSettings();
 
     std::vector<svg::Text> result;
-    svg::Text text_underlayer;
-    svg::Text text_title;
-
-    svg::Point stop_point = proj(stop->point);
-    text_underlayer.SetPosition(stop_point);
-    text_title.SetPosition(stop_point);
-    text_underlayer.SetOffset(render_settings_.stop_label_offset);
-    text_title.SetOffset(render_settings_.stop_label_offset);
-    text_underlayer.SetFontSize(render_settings_.stop_label_font_size);
-    text_title.SetFontSize(render_settings_.stop_label_font_size);
-    text_underlayer.SetFontFamily("Verdana"s);
-    text_title.SetFontFamily("Verdana"s);
-    text_underlayer.SetData(stop->name);
-    text_title.SetData(stop->name);
+
+    svg::Text text;
+    text.SetPosition(proj(stop->point));
+    text.SetOffset(render_settings_.stop_label_offset);
+    text.SetFontSize(render_settings_.stop_label_font_size);
+    text.SetFontFamily("Verdana"s);
+    text.SetData(std::string(stop->name));
+
+    svg::Text text_underlayer = text;
     text_underlayer.SetFillColor(render_settings_.underlayer_color);
     text_underlayer.SetStrokeColor(render_settings_.underlayer_color);
     text_underlayer.SetStrokeWidth(render_settings_.underlayer_width);
     text_underlayer.SetStrokeLineCap(svg::StrokeLineCap::ROUND);
     text_underlayer.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
+    svg::Text text_title = std::move(text);
     text_title.SetFillColor("black"s);
     
     result.emplace_back(std::move(text_underlayer));
@@ -152,8 +315,11 @@ std::vector<svg::Text> MapRenderer::GetStopTitle(const domain::Stop* stop, const
     return result;
 }
 
-svg::Document MapRenderer::GetSvgDocument(const std::unordered_map<std::string_view, const domain::Bus*>& buses) const {
-    svg::Document result; 
+svg::Document MapRenderer::GetSvgDocument(const std::unordered_map<std::string_view, const domain::Bus*>& buses,
+                                          const svg::ParallelFor& parallel_for) const {
+    LoadRenderSettings();
+    svg::Document result;
+    result.SetNumberFormat(render_settings_.number_format);
     std::vector<geo::Coordinates> geo_coords;
     std::vector<std::string_view> bus_names;
     std::map<std::string_view, const domain::Stop*> buses_stops;
@@ -172,16 +338,16 @@ svg::Document MapRenderer::GetSvgDocument(const std::unordered_map<std::string_v
     
     SphereProjector proj(geo_coords.begin(), geo_coords.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
 
-    std::vector<svg::Polyline> bus_routes;
-    std::vector<svg::Text> bus_titles;
+    // Автобусы с непустыми маршрутами в порядке номеров и номера их цветов в палитре
+    std::vector<const domain::Bus*> route_buses;
+    std::vector<size_t> color_numbers;
     size_t color_number = 0;
     for (const auto& bus_name : bus_names) {
-        if (buses.at(bus_name)->stops.size() == 0) continue;
+        const domain::Bus* bus = buses.at(bus_name);
+        if (bus->stops.size() == 0) continue;
 
-        bus_routes.emplace_back(GetBusRoute(buses.at(bus_name), proj, color_number));
-        for (const auto& title : GetBusTitle(buses.at(bus_name), proj, color_number)) {
-            bus_titles.emplace_back(title);
-        }
+        route_buses.push_back(bus);
+        color_numbers.push_back(color_number);
 
         if (color_number < (render_settings_.color_palette.size() - 1)) {
             ++color_number;
@@ -190,21 +356,109 @@ svg::Document MapRenderer::GetSvgDocument(const std::unordered_map<std::string_v
         }
     }
 
-    std::vector<svg::Circle> stop_circles;
-    std::vector<svg::Text> stop_titles;
+    std::vector<const domain::Stop*> stops;
+    std::vector<const domain::Stop*> labelled_stops;
+    stops.reserve(buses_stops.size());
+    labelled_stops.reserve(buses_stops.size());
+    // В режиме упрощения название остановки выводится, только если не перекрывает
+    // названия, выведенные раньше, — в порядке названий остановок
+    std::optional<LabelGrid> placed_labels;
+    if (render_settings_.level_of_detail) {
+        placed_labels.emplace(4.0 * render_settings_.stop_label_font_size);
+    }
     for (const auto& [stop_name, stop] : buses_stops) {
-        stop_circles.emplace_back(GetStopCircle(stop, proj));
-        for (const auto& title : GetStopTitle(stop, proj)) {
-            stop_titles.emplace_back(title);
+        stops.push_back(stop);
+        if (placed_labels) {
+            const svg::Point stop_point = proj(stop->point);
+            const svg::Point position{stop_point.x + render_settings_.stop_label_offset.x,
+                                      stop_point.y + render_settings_.stop_label_offset.y};
+            if (!placed_labels->TryPlace(GetLabelBox(position, stop_name, render_settings_.stop_label_font_size))) {
+                continue;
+            }
         }
+        labelled_stops.push_back(stop);
     }
 
-    for (const auto& bus_route : bus_routes) { result.Add(bus_route); }
-    for (const auto& bus_title : bus_titles) { result.Add(bus_title); }
-    for (const auto& stop_circle : stop_circles) { result.Add(stop_circle); }
-    for (const auto& stop_title : stop_titles) { result.Add(stop_title); }
+    // Слои карты не зависят друг от друга и строятся частями по LAYER_CHUNK_SIZE элементов,
+    // возможно, параллельно. Затем части добавляются в документ в порядке слоёв
+    static const size_t LAYER_CHUNK_SIZE = 256;
+    enum class Layer {
+        BusRoutes,
+        BusTitles,
+        StopCircles,
+        StopTitles,
+    };
+    struct Chunk {
+        Layer layer;
+        size_t begin;
+        size_t end;
+        std::vector<std::unique_ptr<svg::Object>> objects;
+    };
+    std::vector<Chunk> chunks;
+    const auto add_chunks = [&chunks](Layer layer, size_t count) {
+        for (size_t begin = 0; begin < count; begin += LAYER_CHUNK_SIZE) {
+            chunks.push_back({layer, begin, std::min(count, begin + LAYER_CHUNK_SIZE), {}});
+        }
+    };
+    add_chunks(Layer::BusRoutes, route_buses.size());
+    add_chunks(Layer::BusTitles, route_buses.size());
+    add_chunks(Layer::StopCircles, stops.size());
+    add_chunks(Layer::StopTitles, labelled_stops.size());
+
+    parallel_for(chunks.size(), [&](size_t begin, size_t end) {
+        for (size_t chunk_index = begin; chunk_index < end; ++chunk_index) {
+            Chunk& chunk = chunks[chunk_index];
+            for (size_t i = chunk.begin; i < chunk.end; ++i) {
+                switch (chunk.layer) {
+                case Layer::BusRoutes:
+                    chunk.objects.push_back(std::make_unique<svg::Polyline>(
+                        GetBusRoute(route_buses[i], proj, color_numbers[i])));
+                    break;
+                case Layer::BusTitles:
+                    for (auto& title : GetBusTitle(route_buses[i], proj, color_numbers[i])) {
+                        chunk.objects.push_back(std::make_unique<svg::Text>(std::move(title)));
+                    }
+                    break;
+                case Layer::StopCircles:
+                    chunk.objects.push_back(std::make_unique<svg::Circle>(GetStopCircle(stops[i], proj)));
+                    break;
+                case Layer::StopTitles:
+                    for (auto& title : GetStopTitle(labelled_stops[i], proj)) {
+                        chunk.objects.push_back(std::make_unique<svg::Text>(std::move(title)));
+                    }
+                    break;
+                }
+            }
+        }
+    });
+
+    for (Chunk& chunk : chunks) {
+        for (auto& object : chunk.objects) {
+            result.AddPtr(std::move(object));
+        }
+    }
 
     return result;
 }
 
+void MapRenderer::RenderMap(const std::unordered_map<std::string_view, const domain::Bus*>& buses, std::ostream& out,
+                            thread_pool::ThreadPool& pool) const {
+    // На карте меньше чем из PARALLEL_MIN_ROUTE_STOPS точек маршрутов передача частей
+    // в пул обходится дороже, чем их построение и вывод
+    static const size_t PARALLEL_MIN_ROUTE_STOPS = 2048;
+    size_t route_stops_count = 0;
+    for (const auto& [name, bus] : buses) {
+        route_stops_count += bus->stops.size();
+    }
+    if (route_stops_count < PARALLEL_MIN_ROUTE_STOPS) {
+        GetSvgDocument(buses).Render(out);
+        return;
+    }
+
+    const svg::ParallelFor parallel_for = [&pool](size_t count, const std::function<void(size_t, size_t)>& task) {
+        pool.ParallelFor(count, 1, task);
+    };
+    GetSvgDocument(buses, parallel_for).Render(out, parallel_for);
+}
+
 } // namespace renderer
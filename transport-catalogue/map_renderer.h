@@ -3,10 +3,13 @@
 #include "geo.h"
 #include "domain.h"
 #include "svg.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <map>
@@ -94,6 +97,13 @@ struct RenderSettings {
     svg::Color underlayer_color{ };
     double underlayer_width = 0.0;
     std::vector<svg::Color> color_palette{ };
+    // Способ вывода чисел в SVG, на текст карты не влияет
+    svg::NumberFormat number_format = svg::NumberFormat::ToChars;
+    // Режим упрощения карты (level of detail): маятниковые маршруты рисуются в одну
+    // сторону, ломаные упрощаются алгоритмом Дугласа — Пекера с допуском lod_tolerance
+    // пикселей, а названия остановок, перекрывающие уже выведенные, пропускаются
+    bool level_of_detail = false;
+    double lod_tolerance = 1.0;
 };
 
 class MapRenderer {
@@ -103,6 +113,11 @@ public:
 
     void SetRenderSettings(RenderSettings settings);
 
+    // Откладывает получение настроек до первого обращения к ним (обычно до первого
+    // запроса Map): loader вызывается не более одного раза, в том числе из нескольких
+    // потоков. SetRenderSettings отменяет загрузку
+    void SetRenderSettingsLoader(std::function<RenderSettings()> loader);
+
     const RenderSettings& GetRenderSettings() const;
 
     void PrintRenderSettings() const;
@@ -113,12 +128,25 @@ public:
 
     svg::Circle GetStopCircle(const domain::Stop* stop, const SphereProjector& proj) const;
 
-    svg::Document GetSvgDocument(const std::unordered_map<std::string_view, const domain::Bus*>& buses) const;
+    // Строит карту. Слои карты строятся частями с помощью parallel_for, возможно,
+    // параллельно; сама карта от этого не зависит
+    svg::Document GetSvgDocument(const std::unordered_map<std::string_view, const domain::Bus*>& buses,
+                                 const svg::ParallelFor& parallel_for = svg::SequentialFor) const;
+
+    // Строит карту и выводит её в out: слои строятся, а части документа выводятся
+    // в потоках pool. Небольшая карта строится и выводится в вызывающем потоке.
+    // Результат совпадает с GetSvgDocument(buses).Render(out)
+    void RenderMap(const std::unordered_map<std::string_view, const domain::Bus*>& buses, std::ostream& out,
+                   thread_pool::ThreadPool& pool) const;
 
     std::vector<svg::Text> GetStopTitle(const domain::Stop* stop, const SphereProjector& proj) const;
 
 private:
-    RenderSettings render_settings_;
+    void LoadRenderSettings() const;
+
+    mutable std::once_flag render_settings_flag_;
+    mutable std::function<RenderSettings()> render_settings_loader_;
+    mutable RenderSettings render_settings_;
 };
 
 } // namespace renderer
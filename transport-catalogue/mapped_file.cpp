@@ -0,0 +1,105 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRANSPORT_CATALOGUE_WITH_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mapped_file {
+
+using namespace std::literals;
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef TRANSPORT_CATALOGUE_WITH_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open "s + path.string());
+    }
+    try {
+        Map(fd);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    // Отображение остаётся действительным и после закрытия дескриптора
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open "s + path.string());
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+#endif
+}
+
+MappedFile::MappedFile(int fd) {
+#ifdef TRANSPORT_CATALOGUE_WITH_MMAP
+    Map(fd);
+#else
+    // Без отображения поддерживается только стандартный ввод
+    if (fd != 0) {
+        throw std::runtime_error("mapping of file descriptors is not supported"s);
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+#endif
+}
+
+void MappedFile::Map(int fd) {
+#ifdef TRANSPORT_CATALOGUE_WITH_MMAP
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0) {
+        throw std::runtime_error("cannot stat file descriptor"s);
+    }
+    if (!S_ISREG(file_stat.st_mode)) {
+        char chunk[64 * 1024];
+        ssize_t count = 0;
+        while ((count = ::read(fd, chunk, sizeof(chunk))) > 0) {
+            buffer_.append(chunk, static_cast<size_t>(count));
+        }
+        if (count < 0) {
+            throw std::runtime_error("cannot read file descriptor"s);
+        }
+        return;
+    }
+    // Отображение пустого файла не допускается
+    if (file_stat.st_size == 0) {
+        return;
+    }
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("cannot map file"s);
+    }
+    // Файл читается один раз от начала до конца
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    data_ = data;
+    size_ = size;
+#else
+    (void)fd;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef TRANSPORT_CATALOGUE_WITH_MMAP
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+#endif
+}
+
+std::string_view MappedFile::GetData() const {
+    if (data_ != nullptr) {
+        return {static_cast<const char*>(data_), size_};
+    }
+    return buffer_;
+}
+
+} // namespace mapped_file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace mapped_file {
+
+// Содержимое файла, доступное только для чтения. На POSIX-системах файл отображается
+// в память целиком без копирования, на остальных — читается в буфер.
+// Если файл не удаётся открыть, выбрасывается std::runtime_error
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+
+    // Отображает уже открытый файл, например перенаправленный на стандартный ввод.
+    // Дескриптор не закрывается. Если это не обычный файл (канал, терминал),
+    // содержимое читается в буфер до конца
+    explicit MappedFile(int fd);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    std::string_view GetData() const;
+
+private:
+    void Map(int fd);
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::string buffer_;
+};
+
+} // namespace mapped_file
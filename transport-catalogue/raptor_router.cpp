@@ -0,0 +1,194 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace router {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+RaptorRouter::RaptorRouter(const TransportCatalogue& db, int bus_wait_time, double bus_velocity)
+    : wait_time_(bus_wait_time)
+    , meters_per_minute_(bus_velocity * (100.0 / 6.0)) {
+
+    route_offsets_.push_back(0);
+    for (const Bus& bus : db.GetAllRawBuses()) {
+        if (bus.stops.size() < 2) {
+            continue;
+        }
+        if (bus.route_type == RouteType::Pendulum) {
+            const size_t final_position = bus.stops.size() / 2;
+            AddRoute(db, bus, 0, final_position);
+            AddRoute(db, bus, final_position, bus.stops.size() - 1);
+        } else {
+            AddRoute(db, bus, 0, bus.stops.size() - 1);
+        }
+    }
+
+    // Обратный индекс «остановка → маршруты» строится подсчётом
+    std::vector<uint32_t> counts(stops_.size() + 1, 0);
+    for (uint32_t stop : route_stops_) {
+        ++counts[stop + 1];
+    }
+    for (size_t i = 1; i < counts.size(); ++i) {
+        counts[i] += counts[i - 1];
+    }
+    stop_route_offsets_ = counts;
+    stop_routes_.resize(route_stops_.size());
+    for (uint32_t route = 0; route + 1 < route_offsets_.size(); ++route) {
+        for (uint32_t i = route_offsets_[route]; i < route_offsets_[route + 1]; ++i) {
+            stop_routes_[counts[route_stops_[i]]++] = {route, i - route_offsets_[route]};
+        }
+    }
+}
+
+uint32_t RaptorRouter::GetStopIndex(const Stop* stop) {
+    const auto [it, inserted] = stop_indices_.emplace(stop, static_cast<uint32_t>(stops_.size()));
+    if (inserted) {
+        stops_.emplace_back(stop);
+    }
+    return it->second;
+}
+
+void RaptorRouter::AddRoute(const TransportCatalogue& db, const Bus& bus, size_t first, size_t last) {
+    uint32_t distance = 0;
+    for (size_t i = first; i <= last; ++i) {
+        if (i > first) {
+            distance += db.GetDistanceBetweenStops(bus.stops[i - 1]->name, bus.stops[i]->name);
+        }
+        route_stops_.push_back(GetStopIndex(bus.stops[i]));
+        route_distances_.push_back(distance);
+    }
+    route_offsets_.push_back(static_cast<uint32_t>(route_stops_.size()));
+    route_buses_.push_back(&bus);
+}
+
+std::vector<RaptorRouter::Journey> RaptorRouter::BuildRoutes(const Stop* from_stop, const Stop* to_stop) const {
+    if (from_stop == to_stop) {
+        return {Journey{0.0, 0, {}}};
+    }
+    const auto from_it = stop_indices_.find(from_stop);
+    const auto to_it = stop_indices_.find(to_stop);
+    if (from_it == stop_indices_.end() || to_it == stop_indices_.end()) {
+        return {};
+    }
+    const uint32_t source = from_it->second;
+    const uint32_t target = to_it->second;
+    const size_t stops_count = stops_.size();
+    const size_t routes_count = route_buses_.size();
+
+    // arrivals[k][s] — самое раннее прибытие на остановку s не более чем с k посадками,
+    // labels[k][s] — поездка, которой остановка была улучшена в раунде k
+    std::vector<std::vector<double>> arrivals(1, std::vector<double>(stops_count, INF));
+    std::vector<std::vector<Label>> labels(1, std::vector<Label>(stops_count, Label{NONE, 0, 0}));
+    std::vector<double> best_arrivals(stops_count, INF);
+    arrivals[0][source] = 0.0;
+    best_arrivals[source] = 0.0;
+
+    std::vector<char> marked_stops(stops_count, 0);
+    marked_stops[source] = 1;
+    std::vector<uint32_t> route_start(routes_count, NONE);
+    std::vector<uint32_t> queued_routes;
+
+    std::vector<Journey> result;
+    double best_target_arrival = INF;
+
+    for (size_t round = 1; ; ++round) {
+        // Маршруты, проходящие через отмеченные остановки, просматриваются
+        // с самой ранней из таких остановок
+        queued_routes.clear();
+        for (uint32_t stop = 0; stop < stops_count; ++stop) {
+            if (!marked_stops[stop]) {
+                continue;
+            }
+            marked_stops[stop] = 0;
+            for (uint32_t i = stop_route_offsets_[stop]; i < stop_route_offsets_[stop + 1]; ++i) {
+                const auto [route, position] = stop_routes_[i];
+                if (route_start[route] == NONE) {
+                    queued_routes.push_back(route);
+                    route_start[route] = position;
+                } else {
+                    route_start[route] = std::min(route_start[route], position);
+                }
+            }
+        }
+        if (queued_routes.empty()) {
+            break;
+        }
+
+        arrivals.push_back(arrivals[round - 1]);
+        labels.emplace_back(stops_count, Label{NONE, 0, 0});
+        const std::vector<double>& previous = arrivals[round - 1];
+        std::vector<double>& current = arrivals[round];
+        std::vector<Label>& current_labels = labels[round];
+
+        for (uint32_t route : queued_routes) {
+            const uint32_t offset = route_offsets_[route];
+            const uint32_t end = route_offsets_[route + 1] - offset;
+            const uint32_t* stops = route_stops_.data() + offset;
+            const uint32_t* distances = route_distances_.data() + offset;
+
+            uint32_t board_position = NONE;
+            double board_time = INF;
+            for (uint32_t position = route_start[route]; position < end; ++position) {
+                const uint32_t stop = stops[position];
+                double arrival = INF;
+                if (board_position != NONE) {
+                    arrival = board_time + (distances[position] - distances[board_position]) / meters_per_minute_;
+                    if (arrival < std::min(best_arrivals[stop], best_arrivals[target])) {
+                        current[stop] = arrival;
+                        best_arrivals[stop] = arrival;
+                        current_labels[stop] = {route, board_position, position};
+                        marked_stops[stop] = 1;
+                    }
+                }
+                if (previous[stop] + wait_time_ < arrival) {
+                    board_position = position;
+                    board_time = previous[stop] + wait_time_;
+                }
+            }
+            route_start[route] = NONE;
+        }
+
+        if (current[target] < best_target_arrival) {
+            best_target_arrival = current[target];
+            result.push_back(MakeJourney(arrivals, labels, source, target, round));
+        }
+    }
+    return result;
+}
+
+RaptorRouter::Journey RaptorRouter::MakeJourney(const std::vector<std::vector<double>>& arrivals,
+                                                const std::vector<std::vector<Label>>& labels,
+                                                uint32_t source, uint32_t target, size_t rounds) const {
+    Journey journey{arrivals[rounds][target], 0, {}};
+
+    uint32_t stop = target;
+    size_t round = rounds;
+    while (stop != source) {
+        // Метка остановки могла быть установлена в одном из предыдущих раундов
+        while (labels[round][stop].route == NONE) {
+            --round;
+        }
+        const Label& label = labels[round][stop];
+        const uint32_t offset = route_offsets_[label.route];
+        const uint32_t board_stop = route_stops_[offset + label.board_position];
+        const double ride_time = (route_distances_[offset + label.alight_position]
+                                  - route_distances_[offset + label.board_position]) / meters_per_minute_;
+        journey.legs.push_back({route_buses_[label.route], stops_[board_stop],
+                                label.alight_position - label.board_position, wait_time_, ride_time});
+        stop = board_stop;
+        --round;
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+    journey.transfers = journey.legs.empty() ? 0 : journey.legs.size() - 1;
+
+    return journey;
+}
+
+} // namespace router
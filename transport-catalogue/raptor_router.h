@@ -0,0 +1,75 @@
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace router {
+
+using namespace transport_catalogue;
+
+// Многокритериальный маршрутизатор RAPTOR (Round-bAsed Public Transit Routing).
+// Раунд k находит самые быстрые поездки ровно с k посадками, поэтому результат —
+// множество Парето-оптимальных по паре (время в пути, число пересадок) маршрутов.
+// Ожидание автобуса, как и в графе маршрутизации, равно bus_wait_time при каждой посадке.
+// Маршруты автобусов хранятся плоскими массивами: остановки всех маршрутов подряд
+// и накопленные вдоль маршрута расстояния, так что внутренний цикл идёт по памяти линейно.
+// Маятниковый автобус представлен двумя маршрутами — туда и обратно
+class RaptorRouter {
+public:
+    // bus_wait_time — в минутах, bus_velocity — в км/ч
+    RaptorRouter(const TransportCatalogue& db, int bus_wait_time, double bus_velocity);
+
+    struct Journey {
+        double total_time;
+        size_t transfers;
+        std::vector<RouteLeg> legs;
+    };
+
+    // Возвращает Парето-оптимальные маршруты в порядке возрастания числа пересадок
+    // (и убывания времени в пути). Пустой результат означает, что маршрута нет
+    std::vector<Journey> BuildRoutes(const Stop* from_stop, const Stop* to_stop) const;
+
+private:
+    struct Label {
+        uint32_t route;
+        uint32_t board_position;
+        uint32_t alight_position;
+    };
+
+    struct StopRoute {
+        uint32_t route;
+        uint32_t position;
+    };
+
+    uint32_t GetStopIndex(const Stop* stop);
+
+    void AddRoute(const TransportCatalogue& db, const Bus& bus, size_t first, size_t last);
+
+    Journey MakeJourney(const std::vector<std::vector<double>>& arrivals,
+                        const std::vector<std::vector<Label>>& labels,
+                        uint32_t source, uint32_t target, size_t rounds) const;
+
+    double wait_time_;
+    double meters_per_minute_;
+
+    std::vector<const Stop*> stops_;
+    std::unordered_map<const Stop*, uint32_t> stop_indices_;
+
+    // Маршрут r занимает позиции [route_offsets_[r], route_offsets_[r + 1])
+    // в массивах route_stops_ и route_distances_
+    std::vector<uint32_t> route_offsets_;
+    std::vector<uint32_t> route_stops_;
+    std::vector<uint32_t> route_distances_;
+    std::vector<const Bus*> route_buses_;
+
+    // Маршруты, проходящие через остановку s, занимают позиции
+    // [stop_route_offsets_[s], stop_route_offsets_[s + 1]) в stop_routes_
+    std::vector<uint32_t> stop_route_offsets_;
+    std::vector<StopRoute> stop_routes_;
+};
+
+} // namespace router
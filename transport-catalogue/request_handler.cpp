@@ -1,6 +1,7 @@
 #include "request_handler.h"
 #include "svg.h"
 
+#include <iterator>
 #include <unordered_map>
 
 
@@ -10,10 +11,43 @@ const TransportCatalogue& RequestHandler::GetTransportCatalogue() const {
     return db_;
 }
 
+json::Dict RequestHandler::GetBusStat(const Bus& bus) const {
+    using namespace std::literals;
+    auto [route_stops_count, unique_stops_count, route_length, curvature] = db_.GetRouteInfo(&bus);
+    return json::Dict{
+        {"curvature"s, curvature},
+        {"route_length"s, static_cast<int>(route_length)},
+        {"stop_count"s, static_cast<int>(route_stops_count)},
+        {"unique_stop_count"s, static_cast<int>(unique_stops_count)}
+    };
+}
+
+json::Dict RequestHandler::GetStopStat(const Stop& stop) const {
+    using namespace std::literals;
+    json::Array buses;
+    const auto buses_through_stop = db_.GetBusesThroughStop(&stop);
+    buses.reserve(std::distance(buses_through_stop.begin(), buses_through_stop.end()));
+    for (const Bus* bus : buses_through_stop) {
+        buses.emplace_back(std::string(bus->number));
+    }
+    // Список инициализации скопировал бы массив, поэтому он переносится в словарь
+    json::Dict response;
+    response.emplace("buses"s, std::move(buses));
+    return response;
+}
+
 svg::Document RequestHandler::RenderMap() const {
     return renderer_.GetSvgDocument(db_.GetAllBuses());
 }
 
+void RequestHandler::RenderMap(std::ostream& out) const {
+    if (pool_ != nullptr) {
+        renderer_.RenderMap(db_.GetAllBuses(), out, *pool_);
+    } else {
+        renderer_.GetSvgDocument(db_.GetAllBuses()).Render(out);
+    }
+}
+
 std::optional<graph::Router<double>::RouteInfo> RequestHandler::BuildRoute(const Stop* from_stop, const Stop* to_stop) const {
     return router_.GetRouteInfo(from_stop, to_stop);
 }
@@ -21,5 +55,18 @@ std::optional<graph::Router<double>::RouteInfo> RequestHandler::BuildRoute(const
 json::Array RequestHandler::GetEdgesItems(const std::vector<graph::EdgeId>& edges) const {
     return router_.GetEdgesInfo(edges);
 }
+
+std::optional<router::TimetableRouter::RouteInfo> RequestHandler::BuildRoute(const Stop* from_stop, const Stop* to_stop,
+                                                                             double departure_time) const {
+    return router_.GetTimetableRouteInfo(from_stop, to_stop, departure_time);
+}
+
+std::vector<router::RaptorRouter::Journey> RequestHandler::BuildRouteOptions(const Stop* from_stop, const Stop* to_stop) const {
+    return router_.GetRouteOptions(from_stop, to_stop);
+}
+
+json::Array RequestHandler::GetLegsItems(const std::vector<RouteLeg>& legs) const {
+    return router_.GetLegsInfo(legs);
+}
     
 } // namespace transport_catalogue
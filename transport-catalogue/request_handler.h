@@ -3,6 +3,7 @@
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "thread_pool.h"
 
 namespace transport_catalogue {
     
@@ -11,23 +12,43 @@ namespace transport_catalogue {
 // См. паттерн проектирования Фасад: https://ru.wikipedia.org/wiki/Фасад_(шаблон_проектирования)
 class RequestHandler {
 public:
-    RequestHandler(const TransportCatalogue& db, const renderer::MapRenderer& renderer, const router::Router& router)
-        : db_(db), renderer_(renderer), router_(router) {
+    // Пул pool, если задан, используется для построения и вывода больших карт
+    // и должен существовать, пока существует RequestHandler. Без пула карта
+    // строится и выводится в вызывающем потоке
+    RequestHandler(const TransportCatalogue& db, const renderer::MapRenderer& renderer, const router::Router& router,
+                   thread_pool::ThreadPool* pool = nullptr)
+        : db_(db), renderer_(renderer), router_(router), pool_(pool) {
     }
 
     const TransportCatalogue& GetTransportCatalogue() const;
 
+    // Ответы на запросы Bus и Stop без request_id
+    json::Dict GetBusStat(const Bus& bus) const;
+
+    json::Dict GetStopStat(const Stop& stop) const;
+
     svg::Document RenderMap() const;
 
+    // Выводит карту в out, строя и выводя её части в потоках пула, если он задан
+    void RenderMap(std::ostream& out) const;
+
     std::optional<graph::Router<double>::RouteInfo> BuildRoute(const Stop* from_stop, const Stop* to_stop) const;
 
     json::Array GetEdgesItems(const std::vector<graph::EdgeId>& edges) const;
 
+    std::optional<router::TimetableRouter::RouteInfo> BuildRoute(const Stop* from_stop, const Stop* to_stop,
+                                                                 double departure_time) const;
+
+    std::vector<router::RaptorRouter::Journey> BuildRouteOptions(const Stop* from_stop, const Stop* to_stop) const;
+
+    json::Array GetLegsItems(const std::vector<RouteLeg>& legs) const;
+
 private:
     // RequestHandler использует агрегацию объектов "Транспортный Справочник", "Визуализатор Карты" и "Маршрутизатор"
     const TransportCatalogue& db_;
     const renderer::MapRenderer& renderer_;
     const router::Router& router_;
+    thread_pool::ThreadPool* pool_;
 };
 
 } // namespace transport_catalogue
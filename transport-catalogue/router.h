@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <iterator>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -29,6 +30,16 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Восстанавливает таблицу кратчайших путей после того, как в графе изменился
+    // вес ребра edge_id (прежний вес — old_weight). Уменьшение веса обрабатывается
+    // за O(V^2), увеличение — алгоритмом Дейкстры только для тех начальных вершин,
+    // чьи кратчайшие пути проходили через это ребро
+    void UpdateEdgeWeight(EdgeId edge_id, Weight old_weight);
+
+    // Полностью пересчитывает таблицу кратчайших путей, например после того,
+    // как изменились веса почти всех рёбер
+    void Rebuild();
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -75,6 +86,49 @@ private:
         }
     }
 
+    void RelaxRoutesThroughEdge(EdgeId edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            const auto route_from = routes_internal_data_[vertex_from][edge.from];
+            if (!route_from) {
+                continue;
+            }
+            const RouteInternalData route_through{route_from->weight + edge.weight, edge_id};
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                if (const auto& route_to = routes_internal_data_[edge.to][vertex_to]) {
+                    RelaxRoute(vertex_from, vertex_to, route_through, *route_to);
+                }
+            }
+        }
+    }
+
+    void ComputeRoutesFromVertex(VertexId vertex_from) {
+        auto& routes_from = routes_internal_data_[vertex_from];
+        std::fill(routes_from.begin(), routes_from.end(), std::nullopt);
+        routes_from[vertex_from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.emplace(ZERO_WEIGHT, vertex_from);
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > routes_from[vertex]->weight) {
+                continue;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                auto& route = routes_from[edge.to];
+                if (!route || candidate_weight < route->weight) {
+                    route = RouteInternalData{candidate_weight, edge_id};
+                    queue.emplace(candidate_weight, edge.to);
+                }
+            }
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -83,17 +137,45 @@ private:
 template <typename Weight>
 Router<Weight>::Router(const Graph& graph)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
 {
-    InitializeRoutesInternalData(graph);
+    Rebuild();
+}
+
+template <typename Weight>
+void Router<Weight>::Rebuild() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    routes_internal_data_.assign(vertex_count, std::vector<std::optional<RouteInternalData>>(vertex_count));
+
+    InitializeRoutesInternalData(graph_);
 
-    const size_t vertex_count = graph.GetVertexCount();
     for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
         RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
     }
 }
 
+template <typename Weight>
+void Router<Weight>::UpdateEdgeWeight(EdgeId edge_id, Weight old_weight) {
+    const auto& edge = graph_.GetEdge(edge_id);
+    if (edge.weight < ZERO_WEIGHT) {
+        throw std::domain_error("Edges' weights should be non-negative");
+    }
+    if (edge.weight < old_weight) {
+        // Ребро стало короче: улучшиться могут только пути, проходящие через него
+        RelaxRoutesThroughEdge(edge_id);
+    } else if (old_weight < edge.weight) {
+        // Ребро стало длиннее: пересчитываются только начальные вершины,
+        // у которых путь до конца ребра заканчивается этим ребром.
+        // Пути в остальные вершины через ребро восстанавливаются через эту же запись таблицы
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            const auto& route = routes_internal_data_[vertex_from][edge.to];
+            if (route && route->prev_edge == edge_id) {
+                ComputeRoutesFromVertex(vertex_from);
+            }
+        }
+    }
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
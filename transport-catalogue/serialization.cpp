@@ -1,39 +1,365 @@
 #include "serialization.h"
 
+#include <algorithm>
 #include <fstream>
+#include <string_view>
+#include <tuple>
 #include <unordered_set>
 
 namespace serialization {
 
 using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace {
+
+constexpr std::string_view CONTAINER_SIGNATURE = "TCDBPACK"sv;
+
+// Элементов в одной части при параллельном разборе больших массивов
+constexpr size_t CHUNK_SIZE = 1024;
+
+transport_catalogue_serialize::Compression ToProtoCompression(compression::Codec codec) {
+    switch (codec) {
+    case compression::Codec::Zlib:
+        return transport_catalogue_serialize::COMPRESSION_ZLIB;
+    case compression::Codec::Zstd:
+        return transport_catalogue_serialize::COMPRESSION_ZSTD;
+    case compression::Codec::Lz4:
+        return transport_catalogue_serialize::COMPRESSION_LZ4;
+    default:
+        return transport_catalogue_serialize::COMPRESSION_NONE;
+    }
+}
+
+compression::Codec FromProtoCompression(transport_catalogue_serialize::Compression codec) {
+    switch (codec) {
+    case transport_catalogue_serialize::COMPRESSION_ZLIB:
+        return compression::Codec::Zlib;
+    case transport_catalogue_serialize::COMPRESSION_ZSTD:
+        return compression::Codec::Zstd;
+    case transport_catalogue_serialize::COMPRESSION_LZ4:
+        return compression::Codec::Lz4;
+    default:
+        return compression::Codec::None;
+    }
+}
+
+void SerializeStatResponse(const json::Dict& stat, transport_catalogue_serialize::StatResponse& response) {
+    auto [prefix, suffix] = json::PrintFragment(stat, "request_id"s);
+    response.set_prefix(std::move(prefix));
+    response.set_suffix(std::move(suffix));
+}
+
+StatResponse DeserializeStatResponse(const transport_catalogue_serialize::StatResponse& response) {
+    return {response.prefix(), response.suffix()};
+}
+
+svg::Color SetDeserialColor(const renderer_serialize::Color& color) {
+    if (color.is_none()) {
+        return std::monostate();
+    } else if (!color.name().empty()) {
+        return color.name();
+    } else {
+        bool is_rgba = color.rgba().is_rgba();
+        if (is_rgba) {
+            svg::Rgba result;
+            result.red = color.rgba().red();
+            result.green = color.rgba().green();
+            result.blue = color.rgba().blue();
+            result.opacity = color.rgba().opacity();
+            return result;
+        } else {
+            svg::Rgb result;
+            result.red = color.rgba().red();
+            result.green = color.rgba().green();
+            result.blue = color.rgba().blue();
+            return result;
+        }
+    }
+}
+
+renderer::RenderSettings DeserializeRenderSettings(const renderer_serialize::MapRenderer& map_renderer) {
+    renderer::RenderSettings settings;
+
+    settings.width = map_renderer.screen().width();
+    settings.height = map_renderer.screen().height();
+    settings.padding = map_renderer.screen().padding();
+    settings.stop_radius = map_renderer.stop_radius();
+    settings.line_width = map_renderer.line_width();
+
+    settings.bus_label_font_size = static_cast<int>(map_renderer.bus().font_size());
+    settings.bus_label_offset.x = map_renderer.bus().offset().x();
+    settings.bus_label_offset.y = map_renderer.bus().offset().y();
+
+    settings.stop_label_font_size = static_cast<int>(map_renderer.stop().font_size());
+    settings.stop_label_offset.x = map_renderer.stop().offset().x();
+    settings.stop_label_offset.y = map_renderer.stop().offset().y();
+
+    settings.underlayer_width = map_renderer.background().width();
+    settings.underlayer_color = SetDeserialColor(map_renderer.background().color());
+
+    for (const auto& color : map_renderer.color_palette()) {
+        settings.color_palette.emplace_back(SetDeserialColor(color));
+    }
+
+    settings.number_format = map_renderer.number_format() == renderer_serialize::STREAM
+                           ? svg::NumberFormat::Stream : svg::NumberFormat::ToChars;
+    settings.level_of_detail = map_renderer.level_of_detail();
+    if (settings.level_of_detail) {
+        settings.lod_tolerance = map_renderer.lod_tolerance();
+    }
+
+    return settings;
+}
+
+graph::DirectedWeightedGraph<double> DeserializeGraphV1(const router_serialize::Graph& s_graph,
+                                                        const TransportCatalogue& db) {
+    std::vector<graph::Edge<double>> edges(s_graph.edge_size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const router_serialize::Edge& e = s_graph.edge(i);
+        edges[i] = {db.FindName(e.name()), static_cast<size_t>(e.span_count()),
+        static_cast<size_t>(e.from()), static_cast<size_t>(e.to()), e.weight()};
+    }
+
+    std::vector<std::vector<graph::EdgeId>> incidence_lists(s_graph.vertex_size());
+    for (size_t i = 0; i < incidence_lists.size(); ++i) {
+        const router_serialize::Vertex& v = s_graph.vertex(i);
+        incidence_lists[i].reserve(v.edge_id_size());
+        for (const auto& id : v.edge_id()) {
+            incidence_lists[i].push_back(id);
+        }
+    }
+
+    return graph::DirectedWeightedGraph<double>(std::move(edges), std::move(incidence_lists));
+}
+
+graph::DirectedWeightedGraph<double> DeserializeGraph(const transport_catalogue_serialize::DataBase& data_base,
+                                                      const TransportCatalogue& db, thread_pool::ThreadPool& pool) {
+    if (data_base.version() < 2) {
+        return DeserializeGraphV1(data_base.router().graph(), db);
+    }
+    const router_serialize::Graph& s_graph = data_base.router().graph();
+    // Названия рёбер — строки пула справочника. Остановки и автобусы добавлены
+    // в справочник в порядке файла, поэтому индекс в файле совпадает с их номером
+    const auto& stops = db.GetAllRawStops();
+    const auto& buses = db.GetAllRawBuses();
+
+    std::vector<graph::Edge<double>> edges(s_graph.edge_name_size());
+    pool.ParallelFor(edges.size(), CHUNK_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const size_t span_count = s_graph.edge_span_count(i);
+            const uint32_t name = s_graph.edge_name(i);
+            edges[i] = {span_count == 0 ? stops.at(name).name : buses.at(name).number,
+                        span_count, s_graph.edge_from(i), s_graph.edge_to(i), s_graph.edge_weight(i)};
+        }
+    });
+
+    // Списки инцидентности восстанавливаются в порядке номеров рёбер, как при добавлении рёбер в граф
+    std::vector<std::vector<graph::EdgeId>> incidence_lists(s_graph.vertex_count());
+    for (graph::EdgeId i = 0; i < edges.size(); ++i) {
+        incidence_lists.at(edges[i].from).push_back(i);
+    }
+
+    return graph::DirectedWeightedGraph<double>(std::move(edges), std::move(incidence_lists));
+}
+
+std::map<std::string_view, graph::VertexId> DeserializeStopIdsV1(const router_serialize::Router& router,
+                                                                 const TransportCatalogue& db) {
+    std::map<std::string_view, graph::VertexId> stop_ids;
+    for (const auto& s : router.stop_id()) {
+        stop_ids[db.FindName(s.name())] = s.id();
+    }
+    return stop_ids;
+}
+
+std::map<std::string_view, graph::VertexId> DeserializeStopIds(const transport_catalogue_serialize::DataBase& data_base,
+                                                               const TransportCatalogue& db) {
+    if (data_base.version() < 2) {
+        return DeserializeStopIdsV1(data_base.router(), db);
+    }
+    std::map<std::string_view, graph::VertexId> stop_ids;
+    const auto& stop_vertex_ids = data_base.router().stop_vertex_id();
+    const auto& stops = db.GetAllRawStops();
+    for (int i = 0; i < stop_vertex_ids.size(); ++i) {
+        stop_ids.emplace(stops.at(i).name, stop_vertex_ids[i]);
+    }
+    return stop_ids;
+}
+
+} // namespace
 
 Serialization::Serialization(TransportCatalogue& db, renderer::MapRenderer& map_renderer, router::Router& router, const Path& path)
     : db_(db), map_renderer_(map_renderer), router_(router), path_(path) {
 }
 
-void Serialization::SerializeDataBase() {
-    std::ofstream out_file(path_, std::ios::binary);
+void Serialization::SetCompressionSettings(std::optional<compression::Settings> settings) {
+    if (settings && !compression::IsAvailable(settings->codec)) {
+        throw std::logic_error("compression "s + std::string(compression::GetCodecName(settings->codec))
+                               + " is not supported by this build"s);
+    }
+    compression_settings_ = std::move(settings);
+}
 
+void Serialization::SerializeDataBase() {
+    data_base_.set_version(VERSION);
     SerializeTransportCatalogue();
     SerializeMapRenderer();
     SerializeRouter();
 
-    data_base_.SerializeToOstream(&out_file);
+    std::ofstream out_file(path_, std::ios::binary);
+    if (compression_settings_) {
+        WriteContainer(out_file);
+    } else {
+        data_base_.SerializeToOstream(&out_file);
+    }
 }
 
 void Serialization::DeserializeDataBase() {
     std::ifstream in_file(path_, std::ios::binary);
+    thread_pool::ThreadPool pool;
+
+    if (IsContainer(in_file)) {
+        ReadContainer(in_file, pool);
+    } else {
+        data_base_.ParseFromIstream(&in_file);
+    }
+
+    DeserializeTransportCatalogue(pool);
+
+    // Граф маршрутизатора и настройки визуализации нужны не всем запросам, поэтому
+    // восстанавливаются при первом обращении к ним. Разобранная база передаётся
+    // загрузчикам во владение и освобождается, когда они оба отработают
+    auto data_base = std::make_shared<const transport_catalogue_serialize::DataBase>(std::move(data_base_));
+    data_base_.Clear();
+    DeserializeRouter(data_base);
+    DeserializeMapRenderer(data_base);
+}
+
+void Serialization::WriteContainer(std::ostream& output) {
+    const compression::Settings& settings = *compression_settings_;
+
+    const std::pair<transport_catalogue_serialize::SectionType, const google::protobuf::Message*> parts[] = {
+        {transport_catalogue_serialize::SECTION_TRANSPORT_CATALOGUE, &data_base_.transport_catalogue()},
+        {transport_catalogue_serialize::SECTION_MAP_RENDERER, &data_base_.map_renderer()},
+        {transport_catalogue_serialize::SECTION_ROUTER, &data_base_.router()},
+    };
+
+    // Секция делится на блоки по block_size байт, все блоки сжимаются параллельно
+    std::vector<std::string> sections;
+    struct BlockTask {
+        size_t section;
+        size_t offset;
+        size_t size;
+    };
+    std::vector<BlockTask> tasks;
+    for (const auto& [type, message] : parts) {
+        sections.push_back(message->SerializeAsString());
+        const std::string& data = sections.back();
+        for (size_t offset = 0; offset < data.size(); offset += settings.block_size) {
+            tasks.push_back({sections.size() - 1, offset, std::min(settings.block_size, data.size() - offset)});
+        }
+    }
+
+    std::vector<std::string> blocks(tasks.size());
+    thread_pool::ThreadPool pool;
+    pool.ParallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const BlockTask& task = tasks[i];
+            blocks[i] = compression::Compress(settings.codec,
+                                              std::string_view(sections[task.section]).substr(task.offset, task.size),
+                                              settings.level);
+        }
+    });
+
+    transport_catalogue_serialize::Container container;
+    container.set_version(data_base_.version());
+    container.set_compression(ToProtoCompression(settings.codec));
+    for (const auto& [type, message] : parts) {
+        container.add_sections()->set_type(type);
+    }
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        transport_catalogue_serialize::Block& block = *container.mutable_sections(tasks[i].section)->add_blocks();
+        block.set_data(std::move(blocks[i]));
+        block.set_raw_size(tasks[i].size);
+    }
+
+    output.write(CONTAINER_SIGNATURE.data(), CONTAINER_SIGNATURE.size());
+    container.SerializeToOstream(&output);
+}
+
+bool Serialization::IsContainer(std::istream& input) {
+    char signature[CONTAINER_SIGNATURE.size()];
+    if (input.read(signature, sizeof(signature)) && std::string_view(signature, sizeof(signature)) == CONTAINER_SIGNATURE) {
+        return true;
+    }
+    input.clear();
+    input.seekg(0);
+    return false;
+}
 
-    data_base_.ParseFromIstream(&in_file);
+void Serialization::ReadContainer(std::istream& input, thread_pool::ThreadPool& pool) {
+    transport_catalogue_serialize::Container container;
+    if (!container.ParseFromIstream(&input)) {
+        throw std::runtime_error("corrupted database container: "s + path_.string());
+    }
+    const compression::Codec codec = FromProtoCompression(container.compression());
+    data_base_.set_version(container.version());
+
+    // Указатели на части базы берутся заранее: mutable_* меняют общий для них
+    // заголовок сообщения и не должны вызываться из разных потоков
+    std::vector<google::protobuf::Message*> messages;
+    std::vector<std::string> sections(container.sections_size());
+    struct BlockTask {
+        size_t section;
+        size_t offset;
+        const transport_catalogue_serialize::Block* block;
+    };
+    std::vector<BlockTask> tasks;
+    for (int i = 0; i < container.sections_size(); ++i) {
+        const auto& section = container.sections(i);
+        switch (section.type()) {
+        case transport_catalogue_serialize::SECTION_TRANSPORT_CATALOGUE:
+            messages.push_back(data_base_.mutable_transport_catalogue());
+            break;
+        case transport_catalogue_serialize::SECTION_MAP_RENDERER:
+            messages.push_back(data_base_.mutable_map_renderer());
+            break;
+        case transport_catalogue_serialize::SECTION_ROUTER:
+            messages.push_back(data_base_.mutable_router());
+            break;
+        default:
+            throw std::runtime_error("unknown database section in "s + path_.string());
+        }
+
+        size_t size = 0;
+        for (const auto& block : section.blocks()) {
+            tasks.push_back({static_cast<size_t>(i), size, &block});
+            size += block.raw_size();
+        }
+        sections[i].resize(size);
+    }
 
-    DeserializeTransportCatalogue();
-    DeserializeMapRenderer();
-    DeserializeRouter();
+    // Блоки распаковываются сразу на свои места в буферах секций
+    pool.ParallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const BlockTask& task = tasks[i];
+            compression::Decompress(codec, task.block->data(), sections[task.section].data() + task.offset,
+                                    task.block->raw_size());
+        }
+    });
+
+    pool.ParallelFor(sections.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!messages[i]->ParseFromString(sections[i])) {
+                throw std::runtime_error("corrupted database section in "s + path_.string());
+            }
+        }
+    });
 }
 
 transport_catalogue_serialize::Stop Serialization::SerializeStop(const domain::Stop& stop) {
     transport_catalogue_serialize::Stop result;
-    result.set_name(stop.name);
+    result.set_name(stop.name.data(), stop.name.size());
     result.mutable_coordinates()->set_lat(stop.point.lat);
     result.mutable_coordinates()->set_lng(stop.point.lng);
 
@@ -41,48 +367,78 @@ transport_catalogue_serialize::Stop Serialization::SerializeStop(const domain::S
 }
 
 void Serialization::SerializeStops() {
+    const RequestHandler handler(db_, map_renderer_, router_);
     for (const auto& stop : db_.GetAllRawStops()) {
-        *data_base_.mutable_transport_catalogue()->add_stops() = std::move(SerializeStop(stop));
+        stop_indices_.emplace(stop.name, static_cast<uint32_t>(stop_indices_.size()));
+        auto& s_stop = *data_base_.mutable_transport_catalogue()->add_stops();
+        s_stop = std::move(SerializeStop(stop));
+        SerializeStatResponse(handler.GetStopStat(stop), *s_stop.mutable_response());
     }
 }
 
 transport_catalogue_serialize::Distance Serialization::SerializeDistance(const domain::Stop* from, const domain::Stop* to, size_t distance) {
     transport_catalogue_serialize::Distance result;
-    result.set_from(from->name);
-    result.set_to(to->name);
+    result.set_from(from->name.data(), from->name.size());
+    result.set_to(to->name.data(), to->name.size());
     result.set_distance(distance);
 
     return result;
 }
 
 void Serialization::SerializeDistances() {
+    auto& catalogue = *data_base_.mutable_transport_catalogue();
+
+    // Порядок обхода хеш-таблицы зависит от порядка добавления расстояний, поэтому
+    // расстояния упорядочиваются по индексам остановок: одинаковые данные, загруженные
+    // из JSON или из текстового формата, дают одинаковый файл
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> distances;
+    distances.reserve(db_.GetDistancesBetweenStops().size());
     for (const auto& [from_to, distance] : db_.GetDistancesBetweenStops()) {
-        *data_base_.mutable_transport_catalogue()->add_stops_distance() = std::move(SerializeDistance(from_to.first, from_to.second, distance));
+        distances.emplace_back(stop_indices_.at(from_to.first->name), stop_indices_.at(from_to.second->name),
+                               static_cast<uint32_t>(distance));
+    }
+    std::sort(distances.begin(), distances.end());
+
+    catalogue.mutable_distance_from()->Reserve(distances.size());
+    catalogue.mutable_distance_to()->Reserve(distances.size());
+    catalogue.mutable_distance()->Reserve(distances.size());
+    for (const auto& [from, to, distance] : distances) {
+        catalogue.add_distance_from(from);
+        catalogue.add_distance_to(to);
+        catalogue.add_distance(distance);
     }
 }
 
 transport_catalogue_serialize::Bus Serialization::SerializeBus(const domain::Bus& bus) {
     transport_catalogue_serialize::Bus result;
     result.set_route_type(bus.route_type == RouteType::Circular ? true : false);
-    result.set_number(bus.number);
-    for (const auto& stop : bus.stops) {
-        result.add_stops(stop->name);
+    result.set_number(bus.number.data(), bus.number.size());
+    // Маятниковый маршрут записывается до конечной остановки
+    const size_t stops_count = bus.route_type == RouteType::Pendulum && !bus.stops.empty()
+                             ? bus.stops.size() / 2 + 1
+                             : bus.stops.size();
+    result.mutable_stop_ids()->Reserve(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        result.add_stop_ids(stop_indices_.at(bus.stops[i]->name));
     }
-    result.set_route_stops_count(bus.route_stops_count);
     result.set_route_length(bus.route_length);
     result.set_curvature(bus.curvature);
-    if (bus.final_stop) {
-        result.set_final_stop(bus.final_stop->name);
-    } else {
-        result.set_final_stop("");
+    if (bus.schedule) {
+        result.mutable_schedule()->set_first_departure(bus.schedule->first_departure);
+        result.mutable_schedule()->set_last_departure(bus.schedule->last_departure);
+        result.mutable_schedule()->set_headway(bus.schedule->headway);
     }
     
     return result;
 }
 
 void Serialization::SerializeBuses() {
+    const RequestHandler handler(db_, map_renderer_, router_);
     for (const auto& bus : db_.GetAllRawBuses()) {
-        *data_base_.mutable_transport_catalogue()->add_buses() = std::move(SerializeBus(bus));
+        bus_indices_.emplace(bus.number, static_cast<uint32_t>(bus_indices_.size()));
+        auto& s_bus = *data_base_.mutable_transport_catalogue()->add_buses();
+        s_bus = std::move(SerializeBus(bus));
+        SerializeStatResponse(handler.GetBusStat(bus), *s_bus.mutable_response());
     }
 }
 
@@ -92,17 +448,33 @@ void Serialization::SerializeTransportCatalogue() {
     SerializeBuses();
 }
 
-void Serialization::DeserializeStop(const transport_catalogue_serialize::Stop& stop) {
+domain::Stop Serialization::DeserializeStop(const transport_catalogue_serialize::Stop& stop) const {
     domain::Stop result;
     result.name = stop.name();
     result.point.lat = stop.coordinates().lat();
     result.point.lng = stop.coordinates().lng();
-    db_.AddStop(std::move(result));
+    return result;
 }
 
-void Serialization::DeserializeStops() {
-    for (const auto& stop : data_base_.transport_catalogue().stops()) {
-        DeserializeStop(stop);
+void Serialization::DeserializeStops(thread_pool::ThreadPool& pool) {
+    const auto& stops = data_base_.transport_catalogue().stops();
+
+    // Остановки собираются параллельно, а добавляются в справочник по порядку
+    std::vector<domain::Stop> result(stops.size());
+    pool.ParallelFor(result.size(), CHUNK_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = DeserializeStop(stops[i]);
+        }
+    });
+
+    stops_by_index_.reserve(result.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        db_.AddStop(std::move(result[i]));
+        const Stop* stop = db_.FindStop(stops[i].name());
+        stops_by_index_.emplace_back(stop);
+        if (stops[i].has_response()) {
+            db_.SetStatResponse(stop, DeserializeStatResponse(stops[i].response()));
+        }
     }
 }
 
@@ -111,20 +483,75 @@ void Serialization::DeserializeDistance(const transport_catalogue_serialize::Dis
 }
 
 void Serialization::DeserializeDistances() {
+    if (data_base_.version() < 2) {
+        DeserializeDistancesV1();
+        return;
+    }
+    const auto& catalogue = data_base_.transport_catalogue();
+    for (int i = 0; i < catalogue.distance_size(); ++i) {
+        db_.AddDistanceBetweenStops(stops_by_index_.at(catalogue.distance_from(i))->name, catalogue.distance(i),
+                                    stops_by_index_.at(catalogue.distance_to(i))->name);
+    }
+}
+
+void Serialization::DeserializeDistancesV1() {
     for (const auto& distance : data_base_.transport_catalogue().stops_distance()) {
         DeserializeDistance(distance);
     }
 }
 
-void Serialization::DeserializeBus(const transport_catalogue_serialize::Bus& bus) {
+size_t Serialization::GetRouteStopsCount(const transport_catalogue_serialize::Bus& bus) const {
+    if (data_base_.version() < 2) {
+        return bus.stops_size();
+    }
+    return bus.route_type() || bus.stop_ids_size() == 0 ? bus.stop_ids_size() : bus.stop_ids_size() * 2 - 1;
+}
+
+domain::Bus Serialization::DeserializeBus(const transport_catalogue_serialize::Bus& bus,
+                                          std::vector<const Stop*>& stops) const {
+    if (data_base_.version() < 2) {
+        return DeserializeBusV1(bus, stops);
+    }
+    domain::Bus result;
+    result.route_type = bus.route_type() ? RouteType::Circular : RouteType::Pendulum;
+    result.number = bus.number();
+
+    stops.reserve(GetRouteStopsCount(bus));
+    for (uint32_t stop_id : bus.stop_ids()) {
+        stops.emplace_back(stops_by_index_.at(stop_id));
+    }
+    const std::unordered_set<const Stop*> unique_stops(stops.begin(), stops.end());
+    // Маятниковый маршрут разворачивается в обе стороны, как при построении базы
+    if (result.route_type == RouteType::Pendulum && !stops.empty()) {
+        result.final_stop = stops.back();
+        for (int i = static_cast<int>(stops.size()) - 2; i >= 0; --i) {
+            stops.emplace_back(stops[i]);
+        }
+    }
+    result.route_stops_count = stops.size();
+    result.unique_stops_count = unique_stops.size();
+    result.route_length = bus.route_length();
+    result.curvature = bus.curvature();
+    if (bus.has_schedule()) {
+        result.schedule = domain::Schedule{bus.schedule().first_departure(),
+                                           bus.schedule().last_departure(),
+                                           bus.schedule().headway()};
+    }
+
+    return result;
+}
+
+domain::Bus Serialization::DeserializeBusV1(const transport_catalogue_serialize::Bus& bus,
+                                            std::vector<const Stop*>& stops) const {
     std::unordered_set<const Stop*> unique_stops;
     domain::Bus result;
 
     result.route_type = bus.route_type() ? RouteType::Circular : RouteType::Pendulum;
     result.number = bus.number();
+    stops.reserve(bus.stops_size());
     for (const auto& stop : bus.stops()) {
         const Stop* bus_stop = db_.FindStop(stop);
-        result.stops.emplace_back(bus_stop);
+        stops.emplace_back(bus_stop);
         unique_stops.emplace(bus_stop);
     }
     result.route_stops_count = bus.route_stops_count();
@@ -135,24 +562,54 @@ void Serialization::DeserializeBus(const transport_catalogue_serialize::Bus& bus
     if (!bus.final_stop().empty()) {
         result.final_stop = db_.FindStop(bus.final_stop());
     }
-
-    db_.AddBus(std::move(result));
-
-    for (const auto& stop : unique_stops) {
-        db_.AddBusThroughStop(stop, bus.number());
+    if (bus.has_schedule()) {
+        result.schedule = domain::Schedule{bus.schedule().first_departure(),
+                                           bus.schedule().last_departure(),
+                                           bus.schedule().headway()};
     }
+
+    return result;
 }
 
-void Serialization::DeserializeBuses() {
-    for (const auto& bus : data_base_.transport_catalogue().buses()) {
-        DeserializeBus(bus);
+void Serialization::DeserializeBuses(thread_pool::ThreadPool& pool) {
+    const auto& buses = data_base_.transport_catalogue().buses();
+
+    // Автобусы собираются параллельно, а добавляются в справочник по порядку
+    std::vector<domain::Bus> result(buses.size());
+    std::vector<std::vector<const Stop*>> stops(buses.size());
+    pool.ParallelFor(result.size(), CHUNK_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = DeserializeBus(buses[i], stops[i]);
+        }
+    });
+
+    for (size_t i = 0; i < result.size(); ++i) {
+        db_.AddBus(std::move(result[i]), stops[i]);
+        if (buses[i].has_response()) {
+            db_.SetStatResponse(db_.FindBus(buses[i].number()), DeserializeStatResponse(buses[i].response()));
+        }
     }
+    db_.BuildBusesThroughStops();
 }
 
-void Serialization::DeserializeTransportCatalogue() {
-    DeserializeStops();
-    DeserializeDistances();
-    DeserializeBuses();
+void Serialization::DeserializeTransportCatalogue(thread_pool::ThreadPool& pool) {
+    // Место резервируется заранее: тогда расстояния, которые заполняются
+    // одновременно с автобусами, ссылаются на остановки, которые уже не переместятся
+    const auto& catalogue = data_base_.transport_catalogue();
+    size_t route_stops_count = 0;
+    for (const auto& bus : catalogue.buses()) {
+        route_stops_count += GetRouteStopsCount(bus);
+    }
+    db_.Reserve(catalogue.stops_size(), catalogue.buses_size(), route_stops_count);
+
+    DeserializeStops(pool);
+    // Расстояния и автобусы хранятся в разных структурах справочника,
+    // поэтому заполняются одновременно
+    auto distances = pool.Submit([this] {
+        DeserializeDistances();
+    });
+    DeserializeBuses(pool);
+    distances.get();
 }
 
 renderer_serialize::Color Serialization::SetSerialColor(const svg::Color& color) {
@@ -206,58 +663,20 @@ void Serialization::SerializeMapRenderer() {
     for (const auto& color : settings.color_palette) {
         data_base_.mutable_map_renderer()->mutable_color_palette()->Add(SetSerialColor(color));
     }
-}
 
-svg::Color Serialization::SetDeserialColor(const renderer_serialize::Color& color) {
-    if (color.is_none()) {
-        return std::monostate();
-    } else if (!color.name().empty()) {
-        return color.name();
-    } else {
-        bool is_rgba = color.rgba().is_rgba();
-        if (is_rgba) {
-            svg::Rgba result;
-            result.red = color.rgba().red();
-            result.green = color.rgba().green();
-            result.blue = color.rgba().blue();
-            result.opacity = color.rgba().opacity();
-            return result;
-        } else {
-            svg::Rgb result;
-            result.red = color.rgba().red();
-            result.green = color.rgba().green();
-            result.blue = color.rgba().blue();
-            return result;
-        }
+    data_base_.mutable_map_renderer()->set_number_format(settings.number_format == svg::NumberFormat::Stream
+                                                         ? renderer_serialize::STREAM : renderer_serialize::TO_CHARS);
+    // Допуск записывается только вместе с режимом: без него база не отличается от прежней
+    if (settings.level_of_detail) {
+        data_base_.mutable_map_renderer()->set_level_of_detail(true);
+        data_base_.mutable_map_renderer()->set_lod_tolerance(settings.lod_tolerance);
     }
 }
 
-void Serialization::DeserializeMapRenderer() {
-    renderer::RenderSettings settings;
-
-    settings.width = data_base_.map_renderer().screen().width();
-    settings.height = data_base_.map_renderer().screen().height();
-    settings.padding = data_base_.map_renderer().screen().padding();
-    settings.stop_radius = data_base_.map_renderer().stop_radius();
-    settings.line_width = data_base_.map_renderer().line_width();
-
-    settings.bus_label_font_size = static_cast<int>(data_base_.map_renderer().bus().font_size());
-    settings.bus_label_offset.x = data_base_.map_renderer().bus().offset().x();
-    settings.bus_label_offset.y = data_base_.map_renderer().bus().offset().y();
-
-    settings.stop_label_font_size = static_cast<int>(data_base_.map_renderer().stop().font_size());
-    settings.stop_label_offset.x = data_base_.map_renderer().stop().offset().x();
-    settings.stop_label_offset.y = data_base_.map_renderer().stop().offset().y();
-
-    settings.underlayer_width = data_base_.map_renderer().background().width();
-    settings.underlayer_color = SetDeserialColor(data_base_.map_renderer().background().color());
-
-    for (const auto& color : data_base_.map_renderer().color_palette()) {
-        settings.color_palette.emplace_back(SetDeserialColor(color));
-    }
-
-    map_renderer_.SetRenderSettings(std::move(settings));
-    //map_renderer_.PrintRenderSettings();
+void Serialization::DeserializeMapRenderer(std::shared_ptr<const transport_catalogue_serialize::DataBase> data_base) {
+    map_renderer_.SetRenderSettingsLoader([data_base = std::move(data_base)] {
+        return DeserializeRenderSettings(data_base->map_renderer());
+    });
 }
 
 void Serialization::SerializeRoutingSettings() {
@@ -269,38 +688,35 @@ void Serialization::SerializeRoutingSettings() {
 }
 
 void Serialization::SerializeGraph() {
-    router_serialize::Graph result;
-    
-    size_t edge_count = router_.GetGraph().GetEdgeCount();
+    router_serialize::Graph& result = *data_base_.mutable_router()->mutable_graph();
+    const graph::DirectedWeightedGraph<double>& graph = router_.GetGraph();
+
+    const size_t edge_count = graph.GetEdgeCount();
+    result.set_vertex_count(static_cast<uint32_t>(graph.GetVertexCount()));
+    result.mutable_edge_name()->Reserve(edge_count);
+    result.mutable_edge_span_count()->Reserve(edge_count);
+    result.mutable_edge_from()->Reserve(edge_count);
+    result.mutable_edge_to()->Reserve(edge_count);
+    result.mutable_edge_weight()->Reserve(edge_count);
     for (size_t i = 0; i < edge_count; ++i) {
-        const graph::Edge<double>& edge = router_.GetGraph().GetEdge(i);
-        router_serialize::Edge s_edge;
-        s_edge.set_name(edge.name);
-        s_edge.set_span_count(edge.span_count);
-        s_edge.set_from(edge.from);
-        s_edge.set_to(edge.to);
-        s_edge.set_weight(edge.weight);
-
-        *result.add_edge() = s_edge;
-    }
-
-    size_t vertex_count = router_.GetGraph().GetVertexCount();
-    for (size_t i = 0; i < vertex_count; ++i) {
-        router_serialize::Vertex vertex;
-        for (const auto& edge_id : router_.GetGraph().GetIncidentEdges(i)) {
-            vertex.add_edge_id(edge_id);
-        }
-        *result.add_vertex() = vertex;
+        const graph::Edge<double>& edge = graph.GetEdge(i);
+        result.add_edge_name(edge.span_count == 0 ? stop_indices_.at(edge.name) : bus_indices_.at(edge.name));
+        result.add_edge_span_count(static_cast<uint32_t>(edge.span_count));
+        result.add_edge_from(static_cast<uint32_t>(edge.from));
+        result.add_edge_to(static_cast<uint32_t>(edge.to));
+        result.add_edge_weight(edge.weight);
     }
-    *data_base_.mutable_router()->mutable_graph() = result;    
 }
 
 void Serialization::SerializeStopIds() {
-    for (const auto& [name, id] : router_.GetStopIds()) {
-        router_serialize::StopId stop_id;
-        stop_id.set_name(name);
-        stop_id.set_id(id);
-        *data_base_.mutable_router()->add_stop_id() = stop_id;
+    const auto& stop_ids = router_.GetStopIds();
+    if (stop_ids.empty()) {
+        return;
+    }
+    auto& stop_vertex_ids = *data_base_.mutable_router()->mutable_stop_vertex_id();
+    stop_vertex_ids.Resize(static_cast<int>(stop_indices_.size()), 0);
+    for (const auto& [name, id] : stop_ids) {
+        stop_vertex_ids[stop_indices_.at(name)] = static_cast<uint32_t>(id);
     }
 }
 
@@ -310,52 +726,22 @@ void Serialization::SerializeRouter() {
     SerializeStopIds();
 }
 
-void Serialization::DeserializeRoutingSettings() {
+void Serialization::DeserializeRoutingSettings(const transport_catalogue_serialize::DataBase& data_base) {
     router::RoutingSettings settings;
 
-    settings.bus_wait_time = data_base_.router().settings().bus_wait_time();
-    settings.bus_velocity = data_base_.router().settings().bus_velocity();
+    settings.bus_wait_time = data_base.router().settings().bus_wait_time();
+    settings.bus_velocity = data_base.router().settings().bus_velocity();
 
     router_.SetRoutingSettings(std::move(settings));
     //router_.PrintRoutingSettings();
 }
 
-void Serialization::DeserializeGraph() {
-    
-    std::vector<graph::Edge<double>> edges(data_base_.router().graph().edge_size());
-    for (size_t i = 0; i < edges.size(); ++i) {
-        const router_serialize::Edge& e = data_base_.router().graph().edge(i);
-        edges[i] = {e.name(), static_cast<size_t>(e.span_count()),
-        static_cast<size_t>(e.from()), static_cast<size_t>(e.to()), e.weight()};
-    }
-
-    std::vector<std::vector<graph::EdgeId>> incidence_lists(data_base_.router().graph().vertex_size());
-    for (size_t i = 0; i < incidence_lists.size(); ++i) {
-        const router_serialize::Vertex& v = data_base_.router().graph().vertex(i);
-        incidence_lists[i].reserve(v.edge_id_size());
-        for (const auto& id : v.edge_id()) {
-            incidence_lists[i].push_back(id);
-        }
-    }
-
-    graph::DirectedWeightedGraph<double> graph(edges, incidence_lists);
-
-    router_.SetGraph(std::move(graph));
-}
-
-void Serialization::DeserializeStopIds() {
-    std::map<std::string, graph::VertexId> stop_ids;
-    for (const auto& s : data_base_.router().stop_id()) {
-        stop_ids[s.name()] = s.id();
-    }
-
-    router_.SetStopIds(std::move(stop_ids));
-}
-
-void Serialization::DeserializeRouter() {
-    DeserializeRoutingSettings();
-    DeserializeGraph();
-    DeserializeStopIds();
+void Serialization::DeserializeRouter(std::shared_ptr<const transport_catalogue_serialize::DataBase> data_base) {
+    DeserializeRoutingSettings(*data_base);
+    router_.SetGraphLoader([data_base = std::move(data_base), &db = db_] {
+        thread_pool::ThreadPool pool;
+        return router::Router::GraphData{DeserializeGraph(*data_base, db, pool), DeserializeStopIds(*data_base, db)};
+    });
 }
 
 } // namespace serialization
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "compression.h"
 #include "domain.h"
 #include "transport_catalogue.h"
 #include "map_renderer.h"
+#include "request_handler.h"
+#include "thread_pool.h"
 #include "transport_router.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <transport_catalogue.pb.h>
 //#include "build/transport_catalogue.pb.h"
@@ -16,12 +24,32 @@ namespace serialization {
 
 using namespace transport_catalogue;
 
+// Версия 1 хранит остановки в маршрутах, расстояниях, рёбрах графа и идентификаторах
+// вершин полными названиями. Версия 2 ссылается на остановки и автобусы по индексу
+// в порядке их записи в файл, хранит маятниковые маршруты в одну сторону, а рёбра
+// графа и расстояния — упакованными массивами. Записывается всегда версия 2,
+// читаются обе.
+// Если заданы настройки сжатия, база записывается блочно-сжатым контейнером:
+// каталог, настройки визуализации и маршрутизатор — отдельные секции,
+// которые при чтении распаковываются и разбираются параллельно.
+// Формат файла при чтении определяется по сигнатуре.
+// Вместе с остановками и автобусами записываются готовые ответы на запросы Stop и Bus,
+// которые process_requests выводит без построения словаря ответа.
+// При чтении большие массивы остановок, автобусов и рёбер восстанавливаются параллельно
+// на пуле потоков. Порядок добавления объектов в справочник и граф совпадает с порядком
+// в файле, поэтому результат не зависит от числа потоков.
+// Граф маршрутизатора и настройки визуализации восстанавливаются не при чтении файла,
+// а при первом обращении к ним (см. Router::SetGraphLoader, MapRenderer::SetRenderSettingsLoader)
 class Serialization {
 public:
     using Path = std::filesystem::path;
 
+    static constexpr uint32_t VERSION = 2;
+
     Serialization(TransportCatalogue& db, renderer::MapRenderer& map_renderer, router::Router& router, const Path& path);
 
+    void SetCompressionSettings(std::optional<compression::Settings> settings);
+
     void SerializeDataBase();
 
     void DeserializeDataBase();
@@ -32,7 +60,21 @@ private:
     renderer::MapRenderer& map_renderer_;
     router::Router& router_;
     transport_catalogue_serialize::DataBase data_base_;
+    std::optional<compression::Settings> compression_settings_;
+
+    // Индексы остановок и автобусов в файле по названию (при записи)
+    std::unordered_map<std::string_view, uint32_t> stop_indices_;
+    std::unordered_map<std::string_view, uint32_t> bus_indices_;
+    // Остановки по индексу в файле (при чтении)
+    std::vector<const Stop*> stops_by_index_;
     
+    void WriteContainer(std::ostream& output);
+
+    // Проверяет сигнатуру контейнера. Если её нет, возвращает поток в начало
+    static bool IsContainer(std::istream& input);
+
+    void ReadContainer(std::istream& input, thread_pool::ThreadPool& pool);
+
     transport_catalogue_serialize::Stop SerializeStop(const domain::Stop& stop);
 
     void SerializeStops();
@@ -47,27 +89,29 @@ private:
     
     void SerializeTransportCatalogue();
 
-    void DeserializeStop(const transport_catalogue_serialize::Stop& stop);
+    domain::Stop DeserializeStop(const transport_catalogue_serialize::Stop& stop) const;
 
-    void DeserializeStops();
+    void DeserializeStops(thread_pool::ThreadPool& pool);
 
-    void DeserializeTransportCatalogue();
+    void DeserializeTransportCatalogue(thread_pool::ThreadPool& pool);
     
     void DeserializeDistance(const transport_catalogue_serialize::Distance& distance);
 
     void DeserializeDistances();
 
-    void DeserializeBus(const transport_catalogue_serialize::Bus& bus);
+    // Число остановок маршрута вместе с обратным направлением маятникового маршрута
+    size_t GetRouteStopsCount(const transport_catalogue_serialize::Bus& bus) const;
 
-    void DeserializeBuses();
+    // Остановки маршрута записываются в stops
+    domain::Bus DeserializeBus(const transport_catalogue_serialize::Bus& bus, std::vector<const Stop*>& stops) const;
+
+    void DeserializeBuses(thread_pool::ThreadPool& pool);
 
     renderer_serialize::Color SetSerialColor(const svg::Color& color);
 
     void SerializeMapRenderer();
 
-    svg::Color SetDeserialColor(const renderer_serialize::Color& color);
-
-    void DeserializeMapRenderer();
+    void DeserializeMapRenderer(std::shared_ptr<const transport_catalogue_serialize::DataBase> data_base);
 
     void SerializeRoutingSettings();
     
@@ -77,13 +121,13 @@ private:
     
     void SerializeRouter();
 
-    void DeserializeRoutingSettings();
+    void DeserializeRoutingSettings(const transport_catalogue_serialize::DataBase& data_base);
 
-    void DeserializeGraph();
+    void DeserializeDistancesV1();
 
-    void DeserializeStopIds();
+    domain::Bus DeserializeBusV1(const transport_catalogue_serialize::Bus& bus, std::vector<const Stop*>& stops) const;
 
-    void DeserializeRouter();
+    void DeserializeRouter(std::shared_ptr<const transport_catalogue_serialize::DataBase> data_base);
 };
 
 } // namespace serialization
@@ -33,9 +33,9 @@ void PrintQueriesData(TransportCatalogue& catalogue, std::vector<std::string>& q
             const Stop* stop = catalogue.FindStop(query_data);
             if (stop != nullptr) {
                 auto buses_through_stop = catalogue.GetBusesThroughStop(stop);
-                if (buses_through_stop != nullptr) {
+                if (buses_through_stop.begin() != buses_through_stop.end()) {
                     os << "Stop "s << query_data << ": buses"s;
-                    for (const auto& bus : *buses_through_stop) {
+                    for (const auto& bus : buses_through_stop) {
                         os << " "s << bus->number;
                     }
                     os << std::endl;
@@ -0,0 +1,236 @@
+#include "stats.h"
+
+#include "json_builder.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace stats {
+
+using namespace std::string_literals;
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+std::atomic<size_t> allocated_bytes{0};
+
+struct StageRecord {
+    std::string name;
+    double time_ms;
+    size_t allocations;
+    size_t allocated_bytes;
+    size_t peak_rss_kb;
+};
+
+// Корзина k содержит запросы, обработанные быстрее 2^k микросекунд
+struct Histogram {
+    static constexpr size_t BUCKET_COUNT = 32;
+
+    void Add(std::chrono::nanoseconds duration) {
+        const double us = duration.count() / 1000.0;
+        size_t bucket = 0;
+        while (bucket + 1 < BUCKET_COUNT && static_cast<double>(1ull << bucket) <= us) {
+            ++bucket;
+        }
+        ++buckets[bucket];
+        ++count;
+        total += duration;
+        max = std::max(max, duration);
+    }
+
+    std::array<size_t, BUCKET_COUNT> buckets{};
+    size_t count = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+};
+
+struct Registry {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<StageRecord> stages;
+    std::map<std::string, Histogram, std::less<>> requests;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+double ToMilliseconds(std::chrono::nanoseconds duration) {
+    return duration.count() / 1e6;
+}
+
+// Целые числа в json::Node ограничены типом int
+int ToJsonInt(size_t value) {
+    return static_cast<int>(std::min<size_t>(value, std::numeric_limits<int>::max()));
+}
+
+} // namespace
+
+void Enable() {
+    detail::enabled = true;
+    GetRegistry().start = std::chrono::steady_clock::now();
+}
+
+void Disable() {
+    detail::enabled = false;
+}
+
+size_t GetAllocationCount() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+size_t GetAllocatedBytes() {
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+size_t GetPeakRss() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // В Linux ru_maxrss измеряется в килобайтах
+    return static_cast<size_t>(usage.ru_maxrss);
+}
+
+ScopedStage::ScopedStage(std::string_view name)
+    : name_(name) {
+    if (!IsEnabled()) {
+        return;
+    }
+    active_ = true;
+    allocations_ = GetAllocationCount();
+    allocated_bytes_ = GetAllocatedBytes();
+    start_ = std::chrono::steady_clock::now();
+}
+
+ScopedStage::~ScopedStage() {
+    if (!active_) {
+        return;
+    }
+    const auto duration = std::chrono::steady_clock::now() - start_;
+    GetRegistry().stages.push_back({std::string(name_), ToMilliseconds(duration),
+                                    GetAllocationCount() - allocations_,
+                                    GetAllocatedBytes() - allocated_bytes_,
+                                    GetPeakRss()});
+}
+
+ScopedRequest::ScopedRequest(std::string_view type)
+    : type_(type) {
+    if (!IsEnabled()) {
+        return;
+    }
+    active_ = true;
+    start_ = std::chrono::steady_clock::now();
+}
+
+ScopedRequest::~ScopedRequest() {
+    if (!active_) {
+        return;
+    }
+    const auto duration = std::chrono::steady_clock::now() - start_;
+    auto& requests = GetRegistry().requests;
+    auto it = requests.find(type_);
+    if (it == requests.end()) {
+        it = requests.emplace(std::string(type_), Histogram{}).first;
+    }
+    it->second.Add(duration);
+}
+
+json::Document GetReport() {
+    const Registry& registry = GetRegistry();
+
+    json::Array stages;
+    stages.reserve(registry.stages.size());
+    for (const auto& stage : registry.stages) {
+        stages.emplace_back(std::move(json::Builder{}.StartDict()
+            .Key("name"s).Value(stage.name)
+            .Key("time_ms"s).Value(stage.time_ms)
+            .Key("allocations"s).Value(ToJsonInt(stage.allocations))
+            .Key("allocated_kb"s).Value(ToJsonInt(stage.allocated_bytes / 1024))
+            .Key("peak_rss_kb"s).Value(ToJsonInt(stage.peak_rss_kb))
+            .EndDict()).Build());
+    }
+
+    json::Dict requests;
+    for (const auto& [type, histogram] : registry.requests) {
+        json::Array buckets;
+        for (size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+            if (histogram.buckets[i] == 0) {
+                continue;
+            }
+            buckets.emplace_back(std::move(json::Builder{}.StartDict()
+                .Key("le_us"s).Value(ToJsonInt(1ull << i))
+                .Key("count"s).Value(ToJsonInt(histogram.buckets[i]))
+                .EndDict()).Build());
+        }
+        requests.emplace(type, std::move(json::Builder{}.StartDict()
+            .Key("count"s).Value(ToJsonInt(histogram.count))
+            .Key("total_ms"s).Value(ToMilliseconds(histogram.total))
+            .Key("mean_us"s).Value(histogram.total.count() / 1000.0 / histogram.count)
+            .Key("max_us"s).Value(histogram.max.count() / 1000.0)
+            .Key("histogram"s).Value(std::move(buckets))
+            .EndDict()).Build());
+    }
+
+    return json::Document{std::move(json::Builder{}.StartDict()
+        .Key("total_ms"s).Value(ToMilliseconds(std::chrono::steady_clock::now() - registry.start))
+        .Key("peak_rss_kb"s).Value(ToJsonInt(GetPeakRss()))
+        .Key("allocations"s).Value(ToJsonInt(GetAllocationCount()))
+        .Key("allocated_kb"s).Value(ToJsonInt(GetAllocatedBytes() / 1024))
+        .Key("stages"s).Value(std::move(stages))
+        .Key("requests"s).Value(std::move(requests))
+        .EndDict()).Build()};
+}
+
+void PrintReport(const std::filesystem::path& path) {
+    if (path.empty()) {
+        json::Print(GetReport(), std::cerr);
+        std::cerr << std::endl;
+    } else {
+        std::ofstream out(path);
+        json::Print(GetReport(), out);
+        out << std::endl;
+    }
+}
+
+} // namespace stats
+
+// Глобальные operator new/delete заменены, чтобы считать выделения памяти.
+// Пока статистика выключена, к обычному malloc добавляется только проверка флага.
+// Остальные формы (массивы, nothrow) стандартная библиотека выражает через эти
+void* operator new(std::size_t size) {
+    if (stats::IsEnabled()) {
+        stats::allocation_count.fetch_add(1, std::memory_order_relaxed);
+        stats::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* ptr = std::malloc(size)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
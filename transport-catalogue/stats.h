@@ -0,0 +1,80 @@
+#pragma once
+
+#include "json.h"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// Инструментирование этапов работы программы: время, пиковое потребление памяти (RSS),
+// число и объём выделений памяти, гистограммы времени обработки запросов по типам.
+// Включается один раз при старте (флаг --stats). Пока статистика выключена,
+// таймеры сводятся к проверке флага, а счётчик выделений памяти не трогается
+namespace stats {
+
+namespace detail {
+
+inline bool enabled = false;
+
+} // namespace detail
+
+inline bool IsEnabled() {
+    return detail::enabled;
+}
+
+// Включает сбор статистики. Вызывается до начала работы, пока не запущены другие потоки
+void Enable();
+
+// Выключает сбор статистики, собранное сохраняется. Нужно, чтобы замерить
+// выделения памяти на отдельном участке, например в бенчмарке
+void Disable();
+
+// Число и суммарный объём выделений памяти через operator new с момента включения статистики
+size_t GetAllocationCount();
+
+size_t GetAllocatedBytes();
+
+// Пиковый размер резидентной памяти процесса в килобайтах
+size_t GetPeakRss();
+
+// Замеряет этап работы программы от создания до разрушения объекта
+class ScopedStage {
+public:
+    explicit ScopedStage(std::string_view name);
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    ~ScopedStage();
+
+private:
+    std::string_view name_;
+    bool active_ = false;
+    std::chrono::steady_clock::time_point start_;
+    size_t allocations_ = 0;
+    size_t allocated_bytes_ = 0;
+};
+
+// Добавляет время обработки одного запроса в гистограмму его типа
+class ScopedRequest {
+public:
+    explicit ScopedRequest(std::string_view type);
+
+    ScopedRequest(const ScopedRequest&) = delete;
+    ScopedRequest& operator=(const ScopedRequest&) = delete;
+
+    ~ScopedRequest();
+
+private:
+    std::string_view type_;
+    bool active_ = false;
+    std::chrono::steady_clock::time_point start_;
+};
+
+json::Document GetReport();
+
+// Выводит отчёт в файл path, а если путь пуст — в stderr
+void PrintReport(const std::filesystem::path& path);
+
+} // namespace stats
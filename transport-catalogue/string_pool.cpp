@@ -0,0 +1,52 @@
+#include "string_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace string_pool {
+
+namespace {
+
+// Строки длиннее блока получают собственный блок
+constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+} // namespace
+
+std::string_view StringPool::Intern(std::string_view str) {
+    if (auto it = strings_.find(str); it != strings_.end()) {
+        return *it;
+    }
+    if (str.empty()) {
+        return *strings_.emplace().first;
+    }
+
+    if (str.size() > free_size_) {
+        const size_t block_size = std::max(str.size(), BLOCK_SIZE);
+        blocks_.push_back(std::make_unique<char[]>(block_size));
+        free_ = blocks_.back().get();
+        free_size_ = block_size;
+    }
+    std::memcpy(free_, str.data(), str.size());
+    const std::string_view result(free_, str.size());
+    free_ += str.size();
+    free_size_ -= str.size();
+    bytes_ += str.size();
+
+    strings_.insert(result);
+    return result;
+}
+
+std::string_view StringPool::Find(std::string_view str) const {
+    auto it = strings_.find(str);
+    return it == strings_.end() ? std::string_view{} : *it;
+}
+
+size_t StringPool::GetSize() const {
+    return strings_.size();
+}
+
+size_t StringPool::GetBytes() const {
+    return bytes_;
+}
+
+} // namespace string_pool
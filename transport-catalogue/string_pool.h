@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace string_pool {
+
+// Хранилище неизменяемых строк без повторов (интернирование). Каждая строка хранится
+// один раз в блоках памяти, которые не перемещаются, поэтому возвращённые string_view
+// действительны, пока существует пул. Равные строки одного пула имеют один и тот же адрес:
+// их сравнение сводится к сравнению указателей data()
+class StringPool {
+public:
+    StringPool() = default;
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    StringPool(StringPool&&) = default;
+    StringPool& operator=(StringPool&&) = default;
+
+    // Возвращает строку пула, равную str, добавляя её при отсутствии
+    std::string_view Intern(std::string_view str);
+
+    // Возвращает строку пула, равную str, или пустую строку, если такой строки нет
+    std::string_view Find(std::string_view str) const;
+
+    // Число различных строк
+    size_t GetSize() const;
+
+    // Суммарная длина различных строк
+    size_t GetBytes() const;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* free_ = nullptr;
+    size_t free_size_ = 0;
+    size_t bytes_ = 0;
+    std::unordered_set<std::string_view> strings_;
+};
+
+} // namespace string_pool
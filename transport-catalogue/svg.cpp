@@ -1,9 +1,28 @@
 #include "svg.h"
 
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+
 namespace svg {
 
 using namespace std::literals;
 
+void RenderNumber(std::ostream& out, double value, NumberFormat format) {
+#if defined(__cpp_lib_to_chars)
+    if (format == NumberFormat::ToChars) {
+        // Самое длинное число в формате %g с 6 значащими цифрами — вида -1.23457e-308
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+        out.write(buffer, result.ptr - buffer);
+        return;
+    }
+#endif
+    // Сюда же попадает ToChars, если стандартная библиотека не поддерживает std::to_chars для double
+    (void)format;
+    out << value;
+}
+
 void Object::Render(const RenderContext& context) const {
     context.RenderIndent();
 
@@ -12,6 +31,10 @@ void Object::Render(const RenderContext& context) const {
 
     context.out << std::endl;
 }
+void SequentialFor(size_t count, const std::function<void(size_t, size_t)>& task) {
+    task(0, count);
+}
+
 // ---------- Color Prop --------------
 
 void ColorPrinter::operator()(std::monostate) const {
@@ -34,7 +57,8 @@ void ColorPrinter::operator()(Rgba color) const {
        << std::to_string(color.red) << ","s
        << std::to_string(color.green) << ","s
        << std::to_string(color.blue) << ","s;
-    os << color.opacity << ")"s;
+    RenderNumber(os, color.opacity, number_format);
+    os << ")"s;
 }
 
 std::ostream& operator<<(std::ostream& os, const Color& color) {
@@ -84,9 +108,14 @@ Circle& Circle::SetRadius(double radius) {
 
 void Circle::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\""sv;
-    RenderAttrs(out);
+    out << "<circle cx=\""sv;
+    context.RenderNumber(center_.x);
+    out << "\" cy=\""sv;
+    context.RenderNumber(center_.y);
+    out << "\" r=\""sv;
+    context.RenderNumber(radius_);
+    out << "\""sv;
+    RenderAttrs(context);
     out << "/>"sv;
 }
 
@@ -104,14 +133,16 @@ void Polyline::RenderObject(const RenderContext& context) const {
     bool isFirst = true;
     for (const auto& point : points_) {
         if (isFirst) {
-            out << point.x << "," << point.y;
             isFirst = false;
         } else {
-            out << " " << point.x << "," << point.y;
+            out.put(' ');
         }
+        context.RenderNumber(point.x);
+        out.put(',');
+        context.RenderNumber(point.y);
     }
     out << "\""sv;
-    RenderAttrs(out);
+    RenderAttrs(context);
     out << "/>"sv;
 }
 
@@ -142,35 +173,62 @@ Text& Text::SetFontWeight(std::string font_weight) {
     return *this;
 }
 
-Text& Text::SetData(std::string data) {
-    data_ = std::move(data);
-    return *this;
-}
-
-std::string Text::PreprocessingData(const std::string& data) const {
-    std::string result = data;
-
-    for (const auto& [ch, str] : characters_to_change_) {
-        size_t pos = 0;
+namespace {
 
-        while (true) {
-            pos = result.find(ch, pos);
-            if (pos == std::string::npos) {
-                break;
-            }
-            result.replace(pos, 1, str);
-            pos = pos + str.size();
+// Заменяет специальные символы XML сущностями за один проход.
+// Строка без специальных символов (обычный случай) возвращается как есть
+std::string EscapeText(std::string text) {
+    size_t pos = text.find_first_of("&\"'<>"sv);
+    if (pos == std::string::npos) {
+        return text;
+    }
+    std::string result;
+    result.reserve(text.size() + 16);
+    result.append(text, 0, pos);
+    for (; pos < text.size(); ++pos) {
+        switch (text[pos]) {
+        case '&':
+            result += "&amp;"sv;
+            break;
+        case '"':
+            result += "&quot;"sv;
+            break;
+        case '\'':
+            result += "&apos;"sv;
+            break;
+        case '<':
+            result += "&lt;"sv;
+            break;
+        case '>':
+            result += "&gt;"sv;
+            break;
+        default:
+            result += text[pos];
         }
     }
     return result;
 }
 
+} // namespace
+
+Text& Text::SetData(std::string data) {
+    data_ = EscapeText(std::move(data));
+    return *this;
+}
+
 void Text::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
     out << "<text"sv;
-    RenderAttrs(out);
-    out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" "sv;
-    out << "dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\""sv;
+    RenderAttrs(context);
+    out << " x=\""sv;
+    context.RenderNumber(pos_.x);
+    out << "\" y=\""sv;
+    context.RenderNumber(pos_.y);
+    out << "\" dx=\""sv;
+    context.RenderNumber(offset_.x);
+    out << "\" dy=\""sv;
+    context.RenderNumber(offset_.y);
+    out << "\""sv;
     out << " font-size=\""sv << size_ << "\""sv;
     if (!font_family_.empty()) {
         out << " font-family=\""sv << font_family_ << "\""sv;
@@ -178,7 +236,7 @@ void Text::RenderObject(const RenderContext& context) const {
     if (!font_weight_.empty()) {
         out << " font-weight=\""sv << font_weight_ << "\""sv;
     }
-    out << ">" << PreprocessingData(data_) << "</text>"sv;
+    out << ">"sv << data_ << "</text>"sv;
 }
 
 // ---------- Document ----------------
@@ -187,13 +245,52 @@ void Document::AddPtr(std::unique_ptr<Object>&& obj) {
     objects_.emplace_back(std::move(obj));
 }
 
+void Document::SetNumberFormat(NumberFormat number_format) {
+    number_format_ = number_format;
+}
+
 void Document::Render(std::ostream& out) const {
-    RenderContext ctx(out, 2, 2);
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+    RenderContext ctx(out, 2, 2, number_format_);
+    RenderBegin(out);
     for (const auto& object : objects_) {
         object->Render(ctx);
     }
+    RenderEnd(out);
+}
+
+void Document::Render(std::ostream& out, const ParallelFor& parallel_for) const {
+    // Часть достаточно велика, чтобы накладные расходы на буфер были незаметны
+    static const size_t CHUNK_SIZE = 1024;
+
+    const size_t chunks_count = (objects_.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::string> chunks(chunks_count);
+    parallel_for(chunks_count, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            // Буфер перенимает настройки out, в том числе локаль, чтобы вывод не отличался
+            std::ostringstream chunk_out;
+            chunk_out.copyfmt(out);
+            RenderContext ctx(chunk_out, 2, 2, number_format_);
+            const size_t last = std::min(objects_.size(), (chunk + 1) * CHUNK_SIZE);
+            for (size_t i = chunk * CHUNK_SIZE; i < last; ++i) {
+                objects_[i]->Render(ctx);
+            }
+            chunks[chunk] = chunk_out.str();
+        }
+    });
+
+    RenderBegin(out);
+    for (const std::string& chunk : chunks) {
+        out << chunk;
+    }
+    RenderEnd(out);
+}
+
+void Document::RenderBegin(std::ostream& out) const {
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+}
+
+void Document::RenderEnd(std::ostream& out) const {
     out << "</svg>"sv;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -20,23 +21,51 @@ struct Point {
     double y = 0;
 };
 
+/*
+ * Способ вывода чисел с плавающей точкой (координат, радиусов, толщины линий).
+ * Текст одинаков: как у потока с настройками по умолчанию, 6 значащих цифр (%g).
+ * Stream выводит число оператором << потока, ToChars форматирует его std::to_chars
+ * в локальный буфер без обращения к локали и настройкам потока
+ */
+enum class NumberFormat {
+    Stream,
+    ToChars,
+};
+
+// Выводит value в out способом format
+void RenderNumber(std::ostream& out, double value, NumberFormat format);
+
+// Вызывает task(begin, end) для отрезков, вместе покрывающих [0, count), возможно,
+// параллельно. Через неё SVG-документу передаётся пул потоков
+using ParallelFor = std::function<void(size_t count, const std::function<void(size_t, size_t)>& task)>;
+
+// Последовательный вариант ParallelFor: вызывает task(0, count)
+void SequentialFor(size_t count, const std::function<void(size_t, size_t)>& task);
+
 /*
  * Вспомогательная структура, хранящая контекст для вывода SVG-документа с отступами.
- * Хранит ссылку на поток вывода, текущее значение и шаг отступа при выводе элемента
+ * Хранит ссылку на поток вывода, текущее значение и шаг отступа при выводе элемента,
+ * а также способ вывода чисел
  */
 struct RenderContext {
     RenderContext(std::ostream& out)
         : out(out) {
     }
 
-    RenderContext(std::ostream& out, int indent_step, int indent = 0)
+    RenderContext(std::ostream& out, int indent_step, int indent = 0,
+                  NumberFormat number_format = NumberFormat::Stream)
         : out(out)
         , indent_step(indent_step)
-        , indent(indent) {
+        , indent(indent)
+        , number_format(number_format) {
     }
 
     RenderContext Indented() const {
-        return {out, indent_step, indent + indent_step};
+        return {out, indent_step, indent + indent_step, number_format};
+    }
+
+    void RenderNumber(double value) const {
+        svg::RenderNumber(out, value, number_format);
     }
 
     void RenderIndent() const {
@@ -48,6 +77,7 @@ struct RenderContext {
     std::ostream& out;
     int indent_step = 0;
     int indent = 0;
+    NumberFormat number_format = NumberFormat::Stream;
 };
 
 /*
@@ -86,6 +116,7 @@ inline const Color NoneColor{"none"};
 
 struct ColorPrinter {
     std::ostream& os;
+    NumberFormat number_format = NumberFormat::Stream;
 
     void operator()(std::monostate) const;
     void operator()(const std::string& color) const;
@@ -146,17 +177,24 @@ public:
 protected:
     ~PathProps() = default;
 
-    void RenderAttrs(std::ostream& out) const {
+    void RenderAttrs(const RenderContext& context) const {
         using namespace std::literals;
+        auto& out = context.out;
 
         if (fill_color_) {
-            out << " fill=\""sv << *fill_color_ << "\""sv;
+            out << " fill=\""sv;
+            std::visit(ColorPrinter{out, context.number_format}, *fill_color_);
+            out << "\""sv;
         }
         if (stroke_color_) {
-            out << " stroke=\""sv << *stroke_color_ << "\""sv;
+            out << " stroke=\""sv;
+            std::visit(ColorPrinter{out, context.number_format}, *stroke_color_);
+            out << "\""sv;
         }
         if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
+            out << " stroke-width=\""sv;
+            context.RenderNumber(*stroke_width_);
+            out << "\""sv;
         }
         if (stroke_line_cap_) {
             out << " stroke-linecap=\""sv << *stroke_line_cap_ << "\""sv;
@@ -250,12 +288,13 @@ public:
     // Задаёт толщину шрифта (атрибут font-weight)
     Text& SetFontWeight(std::string font_weight);
 
-    // Задаёт текстовое содержимое объекта (отображается внутри тега text)
+    // Задаёт текстовое содержимое объекта (отображается внутри тега text).
+    // Специальные символы XML экранируются здесь, один раз: копии объекта
+    // и повторный вывод используют уже экранированный текст
     Text& SetData(std::string data);
 
     // Прочие данные и методы, необходимые для реализации элемента <text>
 private:
-    std::string PreprocessingData(const std::string& data) const;
     void RenderObject(const RenderContext& context) const override;
 
     Point pos_;
@@ -263,10 +302,8 @@ private:
     uint32_t size_ = 1;
     std::string font_family_;
     std::string font_weight_;
+    // Текст, уже экранированный для вывода
     std::string data_;
-    inline static std::vector<std::pair<char, std::string>> characters_to_change_{
-        {'&', "&amp;"}, {'"', "&quot;"}, {'\'', "&apos;"}, {'<', "&lt;"}, {'>', "&gt;"}
-    };
 };
 
 
@@ -275,7 +312,7 @@ public:
     // Добавляет в svg-документ любой объект-наследник svg::Object
     template <typename T>
     void Add(T obj) {
-        AddPtr(std::make_unique<T>(obj));
+        AddPtr(std::make_unique<T>(std::move(obj)));
     }
 
     virtual void AddPtr(std::unique_ptr<Object>&& obj) = 0;
@@ -287,11 +324,23 @@ public:
     // Добавляет в svg-документ объект-наследник svg::Object
     void AddPtr(std::unique_ptr<Object>&& obj);
 
+    // Задаёт способ вывода чисел, по умолчанию NumberFormat::Stream
+    void SetNumberFormat(NumberFormat number_format);
+
     // Выводит в ostream svg-представление документа
     void Render(std::ostream& out) const;
 
+    // То же, но объекты выводятся частями в отдельные буферы с помощью parallel_for,
+    // а буферы — в out по порядку. Результат совпадает с Render(out)
+    void Render(std::ostream& out, const ParallelFor& parallel_for) const;
+
 private:
+    void RenderBegin(std::ostream& out) const;
+
+    void RenderEnd(std::ostream& out) const;
+
     std::vector<std::unique_ptr<Object>> objects_;
+    NumberFormat number_format_ = NumberFormat::Stream;
 };
 
 
@@ -0,0 +1,118 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace thread_pool {
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    threads_count = std::max<size_t>(threads_count, 1);
+    threads_.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i) {
+        threads_.emplace_back([this] {
+            Work();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopped_ = true;
+    }
+    condition_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::GetThreadsCount() const {
+    return threads_.size();
+}
+
+void ThreadPool::Push(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void ThreadPool::Work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            condition_.wait(lock, [this] {
+                return stopped_ || !tasks_.empty();
+            });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t min_chunk_size, const std::function<void(size_t, size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    const size_t chunk_size = std::max(min_chunk_size, (count + threads_.size() * 4 - 1) / (threads_.size() * 4));
+    const size_t chunks_count = (count + chunk_size - 1) / chunk_size;
+    if (chunks_count == 1) {
+        task(0, count);
+        return;
+    }
+
+    // Состояние разделяется с помощниками: помощник, запущенный пулом уже после того,
+    // как все отрезки разобраны, просто завершается, и вызывающему не нужно его ждать
+    struct State {
+        std::atomic<size_t> next_chunk{0};
+        size_t done_chunks = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<State>();
+
+    auto process_chunks = [state, &task, count, chunk_size, chunks_count] {
+        for (size_t chunk = state->next_chunk++; chunk < chunks_count; chunk = state->next_chunk++) {
+            std::exception_ptr error;
+            try {
+                task(chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(state->mutex);
+            if (error && !state->error) {
+                state->error = error;
+            }
+            if (++state->done_chunks == chunks_count) {
+                state->done.notify_all();
+            }
+        }
+    };
+
+    // Ссылка на task в помощнике используется только пока есть неразобранные отрезки,
+    // а значит, пока вызывающий ещё ждёт внутри ParallelFor
+    const size_t helpers_count = std::min(threads_.size(), chunks_count - 1);
+    for (size_t i = 0; i < helpers_count; ++i) {
+        Push(process_chunks);
+    }
+    process_chunks();
+
+    std::unique_lock lock(state->mutex);
+    state->done.wait(lock, [&state, chunks_count] {
+        return state->done_chunks == chunks_count;
+    });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace thread_pool
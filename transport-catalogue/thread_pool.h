@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+
+// Пул потоков фиксированного размера с общей очередью задач
+class ThreadPool {
+public:
+    // По умолчанию потоков столько, сколько ядер у процессора
+    explicit ThreadPool(size_t threads_count = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Дожидается выполнения всех поставленных задач
+    ~ThreadPool();
+
+    size_t GetThreadsCount() const;
+
+    template <typename Task>
+    auto Submit(Task task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged_task->get_future();
+        Push([packaged_task] {
+            (*packaged_task)();
+        });
+        return result;
+    }
+
+    // Выполняет task(begin, end) для отрезков [0, count), разбитых на части не короче
+    // min_chunk_size. Вызывающий поток обрабатывает отрезки вместе с пулом, поэтому
+    // ParallelFor можно вызывать и из задач самого пула.
+    // Первое выброшенное задачей исключение пробрасывается вызывающему
+    void ParallelFor(size_t count, size_t min_chunk_size, const std::function<void(size_t, size_t)>& task);
+
+private:
+    void Push(std::function<void()> task);
+
+    void Work();
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopped_ = false;
+};
+
+} // namespace thread_pool
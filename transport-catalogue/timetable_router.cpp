@@ -0,0 +1,129 @@
+#include "timetable_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace router {
+
+TimetableRouter::TimetableRouter(const TransportCatalogue& db, double bus_velocity) {
+    const double meters_per_minute = bus_velocity * (100.0 / 6.0);
+
+    for (const Bus& bus : db.GetAllRawBuses()) {
+        if (!bus.schedule || bus.stops.size() < 2) {
+            continue;
+        }
+        const Schedule& schedule = *bus.schedule;
+
+        // Время в пути от начальной остановки считается по накопленному расстоянию,
+        // чтобы ошибки округления не накапливались вдоль длинного маршрута
+        std::vector<double> offsets(bus.stops.size(), 0.0);
+        std::vector<uint32_t> stop_indices(bus.stops.size());
+        size_t length = 0;
+        stop_indices[0] = GetStopIndex(bus.stops[0]);
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            length += db.GetDistanceBetweenStops(bus.stops[i - 1]->name, bus.stops[i]->name);
+            offsets[i] = length / meters_per_minute;
+            stop_indices[i] = GetStopIndex(bus.stops[i]);
+        }
+
+        for (double start = schedule.first_departure; start <= schedule.last_departure; start += schedule.headway) {
+            const uint32_t trip = static_cast<uint32_t>(trip_buses_.size());
+            trip_buses_.emplace_back(&bus);
+            for (size_t i = 1; i < bus.stops.size(); ++i) {
+                connections_.push_back({start + offsets[i - 1], start + offsets[i],
+                                        stop_indices[i - 1], stop_indices[i],
+                                        trip, static_cast<uint32_t>(i - 1)});
+            }
+            if (schedule.headway <= 0.0) {
+                break;
+            }
+        }
+    }
+
+    std::sort(connections_.begin(), connections_.end(), [](const Connection& lhs, const Connection& rhs) {
+        return lhs.departure < rhs.departure || (lhs.departure == rhs.departure && lhs.arrival < rhs.arrival);
+    });
+}
+
+uint32_t TimetableRouter::GetStopIndex(const Stop* stop) {
+    const auto [it, inserted] = stop_indices_.emplace(stop, static_cast<uint32_t>(stops_.size()));
+    if (inserted) {
+        stops_.emplace_back(stop);
+    }
+    return it->second;
+}
+
+size_t TimetableRouter::GetConnectionCount() const {
+    return connections_.size();
+}
+
+std::optional<TimetableRouter::RouteInfo> TimetableRouter::BuildRoute(const Stop* from_stop, const Stop* to_stop,
+                                                                      double departure_time) const {
+    if (from_stop == to_stop) {
+        return RouteInfo{0.0, {}};
+    }
+    const auto from_it = stop_indices_.find(from_stop);
+    const auto to_it = stop_indices_.find(to_stop);
+    if (from_it == stop_indices_.end() || to_it == stop_indices_.end()) {
+        return std::nullopt;
+    }
+    const uint32_t source = from_it->second;
+    const uint32_t target = to_it->second;
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    // Для каждой остановки — самое раннее время прибытия и перегоны посадки и высадки,
+    // которыми закончился лучший путь до неё
+    std::vector<double> earliest_arrival(stops_.size(), INF);
+    std::vector<std::pair<size_t, size_t>> journey(stops_.size(), {NONE, NONE});
+    // Для каждого рейса — перегон, на котором в него можно впервые сесть
+    std::vector<size_t> trip_boarding(trip_buses_.size(), NONE);
+
+    earliest_arrival[source] = departure_time;
+
+    const auto first = std::lower_bound(connections_.begin(), connections_.end(), departure_time,
+        [](const Connection& connection, double time) {
+            return connection.departure < time;
+        });
+
+    for (auto it = first; it != connections_.end(); ++it) {
+        const Connection& connection = *it;
+        if (connection.departure >= earliest_arrival[target]) {
+            break;
+        }
+        size_t& boarding = trip_boarding[connection.trip];
+        if (boarding == NONE && earliest_arrival[connection.from_stop] <= connection.departure) {
+            boarding = it - connections_.begin();
+        }
+        if (boarding != NONE && connection.arrival < earliest_arrival[connection.to_stop]) {
+            earliest_arrival[connection.to_stop] = connection.arrival;
+            journey[connection.to_stop] = {boarding, static_cast<size_t>(it - connections_.begin())};
+        }
+    }
+
+    if (earliest_arrival[target] == INF) {
+        return std::nullopt;
+    }
+
+    std::vector<std::pair<const Connection*, const Connection*>> rides;
+    for (uint32_t stop = target; stop != source;) {
+        const auto [boarding, alighting] = journey[stop];
+        rides.emplace_back(&connections_[boarding], &connections_[alighting]);
+        stop = connections_[boarding].from_stop;
+    }
+    std::reverse(rides.begin(), rides.end());
+
+    RouteInfo result{earliest_arrival[target] - departure_time, {}};
+    result.legs.reserve(rides.size());
+    double time = departure_time;
+    for (const auto& [boarding, alighting] : rides) {
+        result.legs.push_back({trip_buses_[boarding->trip], stops_[boarding->from_stop],
+                               alighting->position - boarding->position + 1,
+                               boarding->departure - time, alighting->arrival - boarding->departure});
+        time = alighting->arrival;
+    }
+    return result;
+}
+
+} // namespace router
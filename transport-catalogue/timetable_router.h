@@ -0,0 +1,55 @@
+#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace router {
+
+using namespace transport_catalogue;
+
+// Маршрутизатор с учётом расписаний автобусов (Connection Scan Algorithm).
+// Каждый рейс автобуса раскладывается на перегоны между соседними остановками,
+// перегоны всех рейсов хранятся одним массивом, упорядоченным по времени отправления.
+// Запрос просматривает массив один раз, начиная с заданного времени отправления,
+// поэтому обход идёт по памяти последовательно.
+// Учитываются только автобусы, для которых задано расписание
+class TimetableRouter {
+public:
+    // bus_velocity — скорость автобуса в км/ч
+    TimetableRouter(const TransportCatalogue& db, double bus_velocity);
+
+    struct RouteInfo {
+        double total_time;
+        std::vector<RouteLeg> legs;
+    };
+
+    // departure_time — время в минутах от начала суток
+    std::optional<RouteInfo> BuildRoute(const Stop* from_stop, const Stop* to_stop, double departure_time) const;
+
+    size_t GetConnectionCount() const;
+
+private:
+    struct Connection {
+        double departure;
+        double arrival;
+        uint32_t from_stop;
+        uint32_t to_stop;
+        uint32_t trip;
+        // Номер перегона в рейсе
+        uint32_t position;
+    };
+
+    uint32_t GetStopIndex(const Stop* stop);
+
+    std::vector<const Stop*> stops_;
+    std::unordered_map<const Stop*, uint32_t> stop_indices_;
+    std::vector<const Bus*> trip_buses_;
+    std::vector<Connection> connections_;
+};
+
+} // namespace router
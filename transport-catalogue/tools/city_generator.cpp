@@ -0,0 +1,496 @@
+// Генератор синтетического города для нагрузочного тестирования.
+// Записывает входные документы для режимов make_base и process_requests.
+// Документы пишутся в поток напрямую, без построения json::Node,
+// поэтому размер города ограничен только памятью под координаты и маршруты.
+//
+// Пример:
+//     city_generator --layout=grid --stops=10000 --buses=2000 --route-length=20
+//                    --make-base=make_base.json --process-requests=process_requests.json
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+enum class Layout {
+    Grid,
+    Radial,
+    Random,
+};
+
+struct Options {
+    Layout layout = Layout::Grid;
+    size_t stops_count = 1000;
+    size_t buses_count = 200;
+    size_t route_length = 10;
+    // Доля кольцевых маршрутов (is_roundtrip = true)
+    double roundtrip_share = 0.5;
+    // Доля перегонов, для которых расстояние в обратную сторону задаётся отдельно
+    double asymmetry = 0.3;
+    size_t requests_count = 1000;
+    // Относительные веса типов запросов
+    double bus_weight = 1.0;
+    double stop_weight = 1.0;
+    double route_weight = 1.0;
+    double route_options_weight = 0.0;
+    size_t maps_count = 1;
+    uint32_t seed = 42;
+    std::string db_path = "transport_catalogue.db"s;
+    std::string make_base_path = "make_base.json"s;
+    std::string process_requests_path = "process_requests.json"s;
+};
+
+struct Point {
+    double lat;
+    double lng;
+};
+
+// Остановки города и связи между соседними остановками, вдоль которых ходят автобусы
+struct City {
+    std::vector<Point> stops;
+    std::vector<std::vector<uint32_t>> neighbours;
+};
+
+struct Route {
+    std::vector<uint32_t> stops;
+    bool is_roundtrip;
+};
+
+constexpr double CENTER_LAT = 55.75;
+constexpr double CENTER_LNG = 37.62;
+// Примерный размер города в градусах
+constexpr double CITY_SIZE = 0.5;
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: city_generator [--layout=grid|radial|random] [--stops=N] [--buses=N]\n"
+              "                      [--route-length=N] [--roundtrip-share=X] [--asymmetry=X]\n"
+              "                      [--requests=N] [--mix=bus:W,stop:W,route:W,route_options:W]\n"
+              "                      [--maps=N] [--seed=N] [--db=FILE]\n"
+              "                      [--make-base=FILE] [--process-requests=FILE]\n"sv;
+}
+
+void Connect(City& city, uint32_t lhs, uint32_t rhs) {
+    city.neighbours[lhs].push_back(rhs);
+    city.neighbours[rhs].push_back(lhs);
+}
+
+// Прямоугольная сетка улиц: каждая остановка связана с соседями по строке и столбцу
+City MakeGridCity(size_t stops_count) {
+    const size_t columns = std::max<size_t>(static_cast<size_t>(std::ceil(std::sqrt(stops_count))), 1);
+    const size_t rows = (stops_count + columns - 1) / columns;
+    const double step = CITY_SIZE / std::max(rows, columns);
+
+    City city;
+    city.stops.reserve(stops_count);
+    city.neighbours.resize(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        const size_t row = i / columns;
+        const size_t column = i % columns;
+        city.stops.push_back({CENTER_LAT - CITY_SIZE / 2 + row * step, CENTER_LNG - CITY_SIZE / 2 + column * step});
+        if (column > 0) {
+            Connect(city, i - 1, i);
+        }
+        if (row > 0) {
+            Connect(city, i - columns, i);
+        }
+    }
+    return city;
+}
+
+// Радиально-кольцевой город: лучи от центра, пересечённые кольцами
+City MakeRadialCity(size_t stops_count) {
+    const size_t rays = std::max<size_t>(static_cast<size_t>(std::sqrt(stops_count)), 3);
+    const size_t rings = (stops_count + rays - 1) / rays;
+    const double step = CITY_SIZE / 2 / std::max<size_t>(rings, 1);
+
+    City city;
+    city.stops.reserve(stops_count);
+    city.neighbours.resize(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        const size_t ring = i / rays;
+        const size_t ray = i % rays;
+        const double angle = 2 * M_PI * ray / rays;
+        const double radius = (ring + 1) * step;
+        city.stops.push_back({CENTER_LAT + radius * std::sin(angle), CENTER_LNG + radius * std::cos(angle)});
+        if (ring > 0) {
+            Connect(city, i - rays, i);
+        }
+        if (ray > 0) {
+            Connect(city, i - 1, i);
+        }
+        if (ray + 1 == rays && rays > 2) {
+            Connect(city, i - ray, i);
+        }
+    }
+    return city;
+}
+
+// Случайный геометрический граф: остановки разбросаны равномерно,
+// связаны остановки ближе заданного радиуса (ищутся по ячейкам сетки)
+City MakeRandomCity(size_t stops_count, std::mt19937& generator) {
+    std::uniform_real_distribution<double> offset(-CITY_SIZE / 2, CITY_SIZE / 2);
+
+    City city;
+    city.stops.reserve(stops_count);
+    city.neighbours.resize(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        city.stops.push_back({CENTER_LAT + offset(generator), CENTER_LNG + offset(generator)});
+    }
+
+    // Радиус выбран так, чтобы у остановки было в среднем около шести соседей
+    const double radius = CITY_SIZE * std::sqrt(6.0 / (M_PI * std::max<size_t>(stops_count, 1)));
+    const size_t cells = std::max<size_t>(static_cast<size_t>(CITY_SIZE / radius), 1);
+    auto get_cell = [&](double value, double center) {
+        const double position = (value - center + CITY_SIZE / 2) / CITY_SIZE;
+        return std::min(static_cast<size_t>(std::max(position, 0.0) * cells), cells - 1);
+    };
+
+    std::vector<std::vector<uint32_t>> grid(cells * cells);
+    for (uint32_t i = 0; i < stops_count; ++i) {
+        grid[get_cell(city.stops[i].lat, CENTER_LAT) * cells + get_cell(city.stops[i].lng, CENTER_LNG)].push_back(i);
+    }
+    for (uint32_t i = 0; i < stops_count; ++i) {
+        const size_t row = get_cell(city.stops[i].lat, CENTER_LAT);
+        const size_t column = get_cell(city.stops[i].lng, CENTER_LNG);
+        for (size_t r = row > 0 ? row - 1 : 0; r <= std::min(row + 1, cells - 1); ++r) {
+            for (size_t c = column > 0 ? column - 1 : 0; c <= std::min(column + 1, cells - 1); ++c) {
+                for (uint32_t j : grid[r * cells + c]) {
+                    const double dlat = city.stops[i].lat - city.stops[j].lat;
+                    const double dlng = city.stops[i].lng - city.stops[j].lng;
+                    if (j > i && dlat * dlat + dlng * dlng <= radius * radius) {
+                        Connect(city, i, j);
+                    }
+                }
+            }
+        }
+    }
+    return city;
+}
+
+// Маршрут — случайное блуждание по соседним остановкам без повторов.
+// Кольцевой маршрут возвращается в начальную остановку
+Route MakeRoute(const City& city, size_t route_length, bool is_roundtrip, std::mt19937& generator) {
+    std::uniform_int_distribution<uint32_t> stop_index(0, static_cast<uint32_t>(city.stops.size() - 1));
+
+    Route route{{stop_index(generator)}, is_roundtrip};
+    std::unordered_set<uint32_t> visited{route.stops.front()};
+    while (route.stops.size() < route_length) {
+        const auto& neighbours = city.neighbours[route.stops.back()];
+        std::vector<uint32_t> candidates;
+        for (uint32_t neighbour : neighbours) {
+            if (visited.count(neighbour) == 0) {
+                candidates.push_back(neighbour);
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        const uint32_t next = candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(generator)];
+        route.stops.push_back(next);
+        visited.insert(next);
+    }
+    if (route.stops.size() < 2) {
+        // Изолированная остановка: маршрут из неё в любую другую
+        route.stops.push_back((route.stops.front() + 1) % city.stops.size());
+    }
+    if (is_roundtrip) {
+        route.stops.push_back(route.stops.front());
+    }
+    return route;
+}
+
+double ComputeDistance(Point from, Point to) {
+    static const double dr = M_PI / 180.;
+    const double angle = std::sin(from.lat * dr) * std::sin(to.lat * dr)
+                       + std::cos(from.lat * dr) * std::cos(to.lat * dr) * std::cos(std::abs(from.lng - to.lng) * dr);
+    return std::acos(std::min(angle, 1.0)) * 6371000;
+}
+
+// Дорожные расстояния, заданные в road_distances остановки stop
+using RoadDistances = std::vector<std::vector<std::pair<uint32_t, int>>>;
+
+void AddRoadDistance(RoadDistances& road_distances, const City& city, uint32_t from, uint32_t to,
+                     std::mt19937& generator) {
+    auto& distances = road_distances[from];
+    if (std::any_of(distances.begin(), distances.end(), [to](const auto& distance) { return distance.first == to; })) {
+        return;
+    }
+    // Дорога длиннее прямой линии на 10–50 %
+    const double factor = std::uniform_real_distribution<double>(1.1, 1.5)(generator);
+    distances.emplace_back(to, std::max(static_cast<int>(ComputeDistance(city.stops[from], city.stops[to]) * factor), 1));
+}
+
+RoadDistances MakeRoadDistances(const City& city, const std::vector<Route>& routes, double asymmetry,
+                                std::mt19937& generator) {
+    std::bernoulli_distribution asymmetric(asymmetry);
+    RoadDistances road_distances(city.stops.size());
+    for (const Route& route : routes) {
+        for (size_t i = 1; i < route.stops.size(); ++i) {
+            AddRoadDistance(road_distances, city, route.stops[i - 1], route.stops[i], generator);
+            // Без отдельного обратного расстояния справочник возьмёт прямое
+            if (asymmetric(generator)) {
+                AddRoadDistance(road_distances, city, route.stops[i], route.stops[i - 1], generator);
+            }
+        }
+    }
+    return road_distances;
+}
+
+std::string GetStopName(size_t index) {
+    return "Stop "s + std::to_string(index);
+}
+
+std::string GetBusName(size_t index) {
+    return std::to_string(index);
+}
+
+// Строка JSON в кавычках: кавычка, обратная косая черта и переводы строк, возврат каретки и табуляция экранируются
+std::string QuoteJson(std::string_view value) {
+    std::string result = "\""s;
+    for (const char c : value) {
+        switch (c) {
+        case '"':
+            result += "\\\""sv;
+            break;
+        case '\\':
+            result += "\\\\"sv;
+            break;
+        case '\n':
+            result += "\\n"sv;
+            break;
+        case '\r':
+            result += "\\r"sv;
+            break;
+        case '\t':
+            result += "\\t"sv;
+            break;
+        default:
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+void PrintMakeBase(std::ostream& out, const Options& options, const City& city,
+                   const std::vector<Route>& routes, const RoadDistances& road_distances) {
+    out << std::setprecision(8);
+    out << "{\n"sv;
+    out << "  \"serialization_settings\": {\"file\": "sv << QuoteJson(options.db_path) << "},\n"sv;
+    out << "  \"routing_settings\": {\"bus_wait_time\": 6, \"bus_velocity\": 40},\n"sv;
+    out << "  \"render_settings\": {\"width\": 1200, \"height\": 1200, \"padding\": 50, \"stop_radius\": 3, "
+           "\"line_width\": 4, \"bus_label_font_size\": 14, \"bus_label_offset\": [7, 15], "
+           "\"stop_label_font_size\": 12, \"stop_label_offset\": [7, -3], "
+           "\"underlayer_color\": [255, 255, 255, 0.85], \"underlayer_width\": 3, "
+           "\"color_palette\": [\"green\", [255, 160, 0], \"red\", [30, 144, 255, 0.8]]},\n"sv;
+    out << "  \"base_requests\": [\n"sv;
+    // Разделитель выводится перед каждым запросом, кроме первого: автобусов может не быть
+    bool first_request = true;
+    const auto print_separator = [&out, &first_request] {
+        out << (first_request ? "    "sv : ",\n    "sv);
+        first_request = false;
+    };
+    for (size_t i = 0; i < city.stops.size(); ++i) {
+        print_separator();
+        out << "{\"type\": \"Stop\", \"name\": \""sv << GetStopName(i)
+            << "\", \"latitude\": "sv << city.stops[i].lat << ", \"longitude\": "sv << city.stops[i].lng
+            << ", \"road_distances\": {"sv;
+        bool first = true;
+        for (const auto& [to, distance] : road_distances[i]) {
+            out << (first ? ""sv : ", "sv) << '"' << GetStopName(to) << "\": "sv << distance;
+            first = false;
+        }
+        out << "}}"sv;
+    }
+    for (size_t i = 0; i < routes.size(); ++i) {
+        print_separator();
+        out << "{\"type\": \"Bus\", \"name\": \""sv << GetBusName(i) << "\", \"stops\": ["sv;
+        for (size_t j = 0; j < routes[i].stops.size(); ++j) {
+            out << (j == 0 ? "\""sv : ", \""sv) << GetStopName(routes[i].stops[j]) << '"';
+        }
+        out << "], \"is_roundtrip\": "sv << (routes[i].is_roundtrip ? "true"sv : "false"sv) << "}"sv;
+    }
+    out << (first_request ? ""sv : "\n"sv) << "  ]\n}\n"sv;
+}
+
+void PrintProcessRequests(std::ostream& out, const Options& options, std::mt19937& generator) {
+    std::uniform_int_distribution<size_t> stop_index(0, options.stops_count - 1);
+    std::uniform_int_distribution<size_t> bus_index(0, std::max<size_t>(options.buses_count, 1) - 1);
+    std::discrete_distribution<int> request_type({options.bus_weight, options.stop_weight,
+                                                  options.route_weight, options.route_options_weight});
+
+    out << "{\n"sv;
+    out << "  \"serialization_settings\": {\"file\": "sv << QuoteJson(options.db_path) << "},\n"sv;
+    out << "  \"stat_requests\": [\n"sv;
+    const size_t total = options.requests_count + options.maps_count;
+    for (size_t id = 1; id <= total; ++id) {
+        out << "    {\"id\": "sv << id << ", "sv;
+        if (id > options.requests_count) {
+            out << "\"type\": \"Map\""sv;
+        } else {
+            switch (request_type(generator)) {
+            case 0:
+                out << "\"type\": \"Bus\", \"name\": \""sv << GetBusName(bus_index(generator)) << '"';
+                break;
+            case 1:
+                out << "\"type\": \"Stop\", \"name\": \""sv << GetStopName(stop_index(generator)) << '"';
+                break;
+            case 2:
+                out << "\"type\": \"Route\", \"from\": \""sv << GetStopName(stop_index(generator))
+                    << "\", \"to\": \""sv << GetStopName(stop_index(generator)) << '"';
+                break;
+            default:
+                out << "\"type\": \"RouteOptions\", \"from\": \""sv << GetStopName(stop_index(generator))
+                    << "\", \"to\": \""sv << GetStopName(stop_index(generator)) << '"';
+                break;
+            }
+        }
+        out << (id == total ? "}\n"sv : "},\n"sv);
+    }
+    out << "  ]\n}\n"sv;
+}
+
+// Разбирает список весов вида bus:3,stop:1,route:2
+void ParseMix(std::string_view mix, Options& options) {
+    while (!mix.empty()) {
+        const auto comma = mix.find(',');
+        const std::string_view item = mix.substr(0, comma);
+        mix = comma == std::string_view::npos ? std::string_view{} : mix.substr(comma + 1);
+
+        const auto colon = item.find(':');
+        if (colon == std::string_view::npos) {
+            throw std::invalid_argument("invalid request mix item: "s + std::string(item));
+        }
+        const std::string_view type = item.substr(0, colon);
+        const double weight = std::stod(std::string(item.substr(colon + 1)));
+        if (type == "bus"sv) {
+            options.bus_weight = weight;
+        } else if (type == "stop"sv) {
+            options.stop_weight = weight;
+        } else if (type == "route"sv) {
+            options.route_weight = weight;
+        } else if (type == "route_options"sv) {
+            options.route_options_weight = weight;
+        } else {
+            throw std::invalid_argument("unknown request type: "s + std::string(type));
+        }
+    }
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument(argv[i]);
+        const auto equal = argument.find('=');
+        if (argument.substr(0, 2) != "--"sv || equal == std::string_view::npos) {
+            throw std::invalid_argument("invalid argument: "s + std::string(argument));
+        }
+        const std::string_view name = argument.substr(2, equal - 2);
+        const std::string value(argument.substr(equal + 1));
+
+        if (name == "layout"sv) {
+            if (value == "grid"s) {
+                options.layout = Layout::Grid;
+            } else if (value == "radial"s) {
+                options.layout = Layout::Radial;
+            } else if (value == "random"s) {
+                options.layout = Layout::Random;
+            } else {
+                throw std::invalid_argument("unknown layout: "s + value);
+            }
+        } else if (name == "stops"sv) {
+            options.stops_count = std::stoul(value);
+        } else if (name == "buses"sv) {
+            options.buses_count = std::stoul(value);
+        } else if (name == "route-length"sv) {
+            options.route_length = std::stoul(value);
+        } else if (name == "roundtrip-share"sv) {
+            options.roundtrip_share = std::stod(value);
+        } else if (name == "asymmetry"sv) {
+            options.asymmetry = std::stod(value);
+        } else if (name == "requests"sv) {
+            options.requests_count = std::stoul(value);
+        } else if (name == "mix"sv) {
+            ParseMix(value, options);
+        } else if (name == "maps"sv) {
+            options.maps_count = std::stoul(value);
+        } else if (name == "seed"sv) {
+            options.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (name == "db"sv) {
+            options.db_path = value;
+        } else if (name == "make-base"sv) {
+            options.make_base_path = value;
+        } else if (name == "process-requests"sv) {
+            options.process_requests_path = value;
+        } else {
+            throw std::invalid_argument("unknown option: "s + std::string(name));
+        }
+    }
+    if (options.stops_count < 2) {
+        throw std::invalid_argument("at least two stops are required"s);
+    }
+    if (options.bus_weight + options.stop_weight + options.route_weight + options.route_options_weight <= 0.0) {
+        throw std::invalid_argument("request mix must have a positive weight"s);
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        PrintUsage();
+        return 1;
+    }
+
+    std::mt19937 generator(options.seed);
+
+    City city;
+    switch (options.layout) {
+    case Layout::Grid:
+        city = MakeGridCity(options.stops_count);
+        break;
+    case Layout::Radial:
+        city = MakeRadialCity(options.stops_count);
+        break;
+    case Layout::Random:
+        city = MakeRandomCity(options.stops_count, generator);
+        break;
+    }
+
+    std::bernoulli_distribution roundtrip(options.roundtrip_share);
+    std::vector<Route> routes;
+    routes.reserve(options.buses_count);
+    for (size_t i = 0; i < options.buses_count; ++i) {
+        routes.push_back(MakeRoute(city, std::max<size_t>(options.route_length, 2), roundtrip(generator), generator));
+    }
+    const RoadDistances road_distances = MakeRoadDistances(city, routes, options.asymmetry, generator);
+
+    std::ofstream make_base(options.make_base_path);
+    PrintMakeBase(make_base, options, city, routes, road_distances);
+
+    std::ofstream process_requests(options.process_requests_path);
+    PrintProcessRequests(process_requests, options, generator);
+
+    if (!make_base || !process_requests) {
+        std::cerr << "failed to write output files\n"sv;
+        return 1;
+    }
+}
@@ -0,0 +1,88 @@
+#!/bin/bash
+# Нагрузочный тест: для каждого размера города генерирует входные документы,
+# запускает make_base и process_requests и записывает в CSV время работы,
+# пиковый RSS (из отчёта --stats) и размеры базы и ответа.
+#
+# Usage: load_test.sh BUILD_DIR [SIZES] [LAYOUT] [OUTPUT_CSV]
+#     BUILD_DIR  — каталог сборки с transport_catalogue и city_generator
+#     SIZES      — числа остановок через запятую, по умолчанию 1000,10000,100000
+#     LAYOUT     — grid, radial или random, по умолчанию grid
+#     OUTPUT_CSV — файл результатов, по умолчанию load_test.csv
+#
+# Дополнительные параметры генератора передаются через переменную GENERATOR_ARGS,
+# например GENERATOR_ARGS="--mix=bus:1,stop:1,route:0 --requests=5000".
+# Таблица маршрутов строится за O(V^3) и занимает O(V^2) памяти, поэтому на больших
+# городах make_base или process_requests может не завершиться — в таблице тогда будет failed
+
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+    sed -n '2,15p' "$0" | sed 's/^# \{0,1\}//'
+    exit 1
+fi
+
+BUILD_DIR=$(cd "$1" && pwd)
+SIZES=${2:-1000,10000,100000}
+LAYOUT=${3:-grid}
+OUTPUT=${4:-load_test.csv}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Пиковый RSS процесса в килобайтах из JSON-отчёта --stats
+# (общий показатель отчёта идёт раньше показателей этапов)
+peak_rss() {
+    if [ -f "$1" ]; then
+        grep -o '"peak_rss_kb": [0-9]*' "$1" | head -n 1 | grep -o '[0-9]*$'
+    fi
+}
+
+# Размер файла в байтах или failed, если файла нет
+file_size() {
+    if [ -f "$1" ]; then
+        stat -c %s "$1"
+    else
+        echo failed
+    fi
+}
+
+# Время работы команды в миллисекундах: run_timed INPUT OUTPUT COMMAND...
+# Если команда завершилась с ошибкой (например, не хватило памяти), выводит failed
+run_timed() {
+    local input=$1 output=$2 start end
+    shift 2
+    start=$(date +%s%N)
+    if ! "$@" < "$input" > "$output"; then
+        echo failed
+        return
+    fi
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+echo "layout,stops,buses,make_base_ms,make_base_rss_kb,db_bytes,process_requests_ms,process_requests_rss_kb,response_bytes" > "$OUTPUT"
+
+IFS=',' read -ra STOPS <<< "$SIZES"
+for stops in "${STOPS[@]}"; do
+    buses=$(( stops / 5 > 0 ? stops / 5 : 1 ))
+    db="$WORK_DIR/city.db"
+    rm -f "$WORK_DIR"/*
+
+    # shellcheck disable=SC2086
+    "$BUILD_DIR/city_generator" --layout="$LAYOUT" --stops="$stops" --buses="$buses" --db="$db" \
+        --make-base="$WORK_DIR/make_base.json" --process-requests="$WORK_DIR/process_requests.json" \
+        ${GENERATOR_ARGS:-}
+
+    make_ms=$(run_timed "$WORK_DIR/make_base.json" /dev/null \
+        "$BUILD_DIR/transport_catalogue" make_base --stats="$WORK_DIR/make_stats.json")
+    # Без базы process_requests запускать не на чем
+    process_ms=failed
+    if [ "$make_ms" != failed ]; then
+        process_ms=$(run_timed "$WORK_DIR/process_requests.json" "$WORK_DIR/response.json" \
+            "$BUILD_DIR/transport_catalogue" process_requests --stats="$WORK_DIR/process_stats.json")
+    fi
+
+    line="$LAYOUT,$stops,$buses,$make_ms,$(peak_rss "$WORK_DIR/make_stats.json"),$(file_size "$db")"
+    line="$line,$process_ms,$(peak_rss "$WORK_DIR/process_stats.json"),$(file_size "$WORK_DIR/response.json")"
+    echo "$line" | tee -a "$OUTPUT"
+done
@@ -1,45 +1,204 @@
 #include "transport_catalogue.h"
 
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+
 namespace transport_catalogue {
 
-void TransportCatalogue::AddBus(const Bus& bus) {
-    const auto pos = buses_.insert(buses_.begin(), std::move(bus));
-    index_buses_.insert({pos->number, &(*pos)});
+namespace {
+
+// Минимальная ёмкость массива при росте без предварительного резервирования
+constexpr size_t MIN_CAPACITY = 16;
+
+size_t GetGrownCapacity(size_t capacity, size_t required) {
+    return std::max({required, capacity * 2, MIN_CAPACITY});
+}
+
+} // namespace
+
+void TransportCatalogue::Reserve(size_t stops_count, size_t buses_count, size_t route_stops_count) {
+    ReserveStops(stops_count);
+    ReserveBuses(buses_count);
+    ReserveRouteStops(route_stops_count);
+    index_stops_.reserve(stops_count);
+    index_buses_.reserve(buses_count);
+}
+
+void TransportCatalogue::ReserveStops(size_t capacity) {
+    if (capacity <= stops_.capacity()) {
+        return;
+    }
+
+    // Ссылки на остановки переводятся в номера до перемещения остановок и обратно после него
+    std::vector<size_t> route_stop_ids;
+    route_stop_ids.reserve(route_stops_.size());
+    for (const Stop* stop : route_stops_) {
+        route_stop_ids.push_back(stop->id);
+    }
+    std::vector<std::optional<size_t>> final_stop_ids;
+    final_stop_ids.reserve(buses_.size());
+    for (const Bus& bus : buses_) {
+        final_stop_ids.push_back(bus.final_stop != nullptr ? std::optional(bus.final_stop->id) : std::nullopt);
+    }
+    std::vector<std::tuple<size_t, size_t, size_t>> distances;
+    distances.reserve(index_distances_between_stops_.size());
+    for (const auto& [from_to, distance] : index_distances_between_stops_) {
+        distances.emplace_back(from_to.first->id, from_to.second->id, distance);
+    }
+
+    stops_.reserve(capacity);
+
+    index_stops_.clear();
+    for (const Stop& stop : stops_) {
+        index_stops_.emplace(stop.name, &stop);
+    }
+    for (size_t i = 0; i < route_stops_.size(); ++i) {
+        route_stops_[i] = &stops_[route_stop_ids[i]];
+    }
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        buses_[i].final_stop = final_stop_ids[i] ? &stops_[*final_stop_ids[i]] : nullptr;
+    }
+    index_distances_between_stops_.clear();
+    for (const auto& [from, to, distance] : distances) {
+        index_distances_between_stops_.emplace(std::pair(&stops_[from], &stops_[to]), distance);
+    }
+}
+
+void TransportCatalogue::ReserveBuses(size_t capacity) {
+    if (capacity <= buses_.capacity()) {
+        return;
+    }
+    buses_.reserve(capacity);
+
+    index_buses_.clear();
+    for (const Bus& bus : buses_) {
+        index_buses_.emplace(bus.number, &bus);
+    }
+    buses_through_stop_offsets_.clear();
+}
+
+void TransportCatalogue::ReserveRouteStops(size_t capacity) {
+    if (capacity <= route_stops_.capacity()) {
+        return;
+    }
+    route_stops_.reserve(capacity);
+
+    // Маршруты автобусов лежат в общем массиве подряд в порядке добавления автобусов
+    const Stop* const* data = route_stops_.data();
+    for (Bus& bus : buses_) {
+        bus.stops = StopSpan(data, bus.stops.size());
+        data += bus.stops.size();
+    }
+}
+
+void TransportCatalogue::AddBus(Bus bus, const std::vector<const Stop*>& stops) {
+    if (buses_.size() == buses_.capacity()) {
+        ReserveBuses(GetGrownCapacity(buses_.capacity(), buses_.size() + 1));
+    }
+    if (route_stops_.size() + stops.size() > route_stops_.capacity()) {
+        ReserveRouteStops(GetGrownCapacity(route_stops_.capacity(), route_stops_.size() + stops.size()));
+    }
+
+    const size_t offset = route_stops_.size();
+    route_stops_.insert(route_stops_.end(), stops.begin(), stops.end());
+    bus.stops = StopSpan(route_stops_.data() + offset, stops.size());
+    bus.id = buses_.size();
+    bus.number = names_.Intern(bus.number);
+
+    const Bus& added = buses_.emplace_back(std::move(bus));
+    index_buses_.emplace(added.number, &added);
+    buses_through_stop_offsets_.clear();
 }
 
-void TransportCatalogue::AddStop(const Stop& stop) {
-    const auto pos = stops_.insert(stops_.begin(), std::move(stop));
-    index_stops_.insert({pos->name, &(*pos)});
+void TransportCatalogue::AddStop(Stop stop) {
+    if (stops_.size() == stops_.capacity()) {
+        ReserveStops(GetGrownCapacity(stops_.capacity(), stops_.size() + 1));
+    }
+
+    stop.id = stops_.size();
+    stop.name = names_.Intern(stop.name);
+    const Stop& added = stops_.emplace_back(std::move(stop));
+    index_stops_.emplace(added.name, &added);
+    buses_through_stop_offsets_.clear();
 }
 
-const Bus* TransportCatalogue::FindBus(const std::string& name) const {
+const Bus* TransportCatalogue::FindBus(std::string_view name) const {
     auto it = index_buses_.find(name);
     return it == index_buses_.end() ? nullptr : it->second;
 }
 
-const Stop* TransportCatalogue::FindStop(const std::string& name) const {
+const Stop* TransportCatalogue::FindStop(std::string_view name) const {
     auto it = index_stops_.find(name);
     return it == index_stops_.end() ? nullptr : it->second;
 }
 
+std::string_view TransportCatalogue::FindName(std::string_view name) const {
+    return names_.Find(name);
+}
+
 std::tuple<size_t, size_t, size_t, double> TransportCatalogue::GetRouteInfo(const Bus* bus) const {
     return {bus->route_stops_count, bus->unique_stops_count, bus->route_length, bus->curvature};
 }
 
-void TransportCatalogue::AddBusThroughStop(const Stop* stop, const std::string& bus_number) {
-    index_buses_through_stop_[stop].emplace(FindBus(bus_number));
+void TransportCatalogue::BuildBusesThroughStops() {
+    std::vector<const Bus*> buses;
+    buses.reserve(buses_.size());
+    for (const Bus& bus : buses_) {
+        buses.push_back(&bus);
+    }
+    std::sort(buses.begin(), buses.end(), detail::CompareBuses{});
+
+    // Остановка может встречаться в маршруте несколько раз, поэтому для каждой
+    // остановки запоминается последний учтённый автобус
+    const size_t no_bus = buses.size();
+    std::vector<size_t> last_bus(stops_.size(), no_bus);
+    std::vector<size_t> offsets(stops_.size() + 1, 0);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        for (const Stop* stop : buses[i]->stops) {
+            if (last_bus[stop->id] != i) {
+                last_bus[stop->id] = i;
+                ++offsets[stop->id + 1];
+            }
+        }
+    }
+    for (size_t id = 0; id < stops_.size(); ++id) {
+        offsets[id + 1] += offsets[id];
+    }
+
+    // Автобусы обходятся в порядке номеров, поэтому у каждой остановки
+    // они оказываются упорядоченными без отдельной сортировки
+    std::vector<const Bus*> buses_through_stops(offsets.back());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    std::fill(last_bus.begin(), last_bus.end(), no_bus);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        for (const Stop* stop : buses[i]->stops) {
+            if (last_bus[stop->id] != i) {
+                last_bus[stop->id] = i;
+                buses_through_stops[positions[stop->id]++] = buses[i];
+            }
+        }
+    }
+
+    buses_through_stop_offsets_ = std::move(offsets);
+    buses_through_stops_ = std::move(buses_through_stops);
 }
 
-const std::set<const Bus*, detail::CompareBuses>* TransportCatalogue::GetBusesThroughStop(const Stop* stop) const {
-    auto it = index_buses_through_stop_.find(stop);
-    return it == index_buses_through_stop_.end() ? nullptr : &(it->second);
+ranges::Range<std::vector<const Bus*>::const_iterator> TransportCatalogue::GetBusesThroughStop(const Stop* stop) const {
+    using namespace std::literals;
+    if (stop->id + 1 >= buses_through_stop_offsets_.size()) {
+        throw std::logic_error("buses through stop index is not built"s);
+    }
+    return {buses_through_stops_.begin() + buses_through_stop_offsets_[stop->id],
+            buses_through_stops_.begin() + buses_through_stop_offsets_[stop->id + 1]};
 }
 
-void TransportCatalogue::AddDistanceBetweenStops(const std::string& from_stop, const size_t distance, const std::string& to_stop) {
+void TransportCatalogue::AddDistanceBetweenStops(std::string_view from_stop, const size_t distance, std::string_view to_stop) {
     index_distances_between_stops_.emplace(std::pair(FindStop(from_stop), FindStop(to_stop)), distance);
 }
 
-size_t TransportCatalogue::GetDistanceBetweenStops(const std::string& from_stop, const std::string& to_stop) const {
+size_t TransportCatalogue::GetDistanceBetweenStops(std::string_view from_stop, std::string_view to_stop) const {
     auto it = index_distances_between_stops_.find(std::pair(FindStop(from_stop), FindStop(to_stop)));
 
     if (it != index_distances_between_stops_.end()) {
@@ -50,6 +209,24 @@ size_t TransportCatalogue::GetDistanceBetweenStops(const std::string& from_stop,
     }
 }
 
+void TransportCatalogue::SetStatResponse(const Bus* bus, StatResponse response) {
+    bus_responses_[bus->id] = std::move(response);
+}
+
+void TransportCatalogue::SetStatResponse(const Stop* stop, StatResponse response) {
+    stop_responses_[stop->id] = std::move(response);
+}
+
+const StatResponse* TransportCatalogue::GetStatResponse(const Bus* bus) const {
+    auto it = bus_responses_.find(bus->id);
+    return it == bus_responses_.end() ? nullptr : &(it->second);
+}
+
+const StatResponse* TransportCatalogue::GetStatResponse(const Stop* stop) const {
+    auto it = stop_responses_.find(stop->id);
+    return it == stop_responses_.end() ? nullptr : &(it->second);
+}
+
 const std::unordered_map<std::string_view, const Bus*>& TransportCatalogue::GetAllBuses() const {
     return index_buses_;
 }
@@ -58,11 +235,11 @@ const std::unordered_map<std::string_view, const Stop*>& TransportCatalogue::Get
     return index_stops_;
 }
 
-const std::deque<Bus>& TransportCatalogue::GetAllRawBuses() const {
+const std::vector<Bus>& TransportCatalogue::GetAllRawBuses() const {
     return buses_;
 }
 
-const std::deque<Stop>& TransportCatalogue::GetAllRawStops() const {
+const std::vector<Stop>& TransportCatalogue::GetAllRawStops() const {
     return stops_;
 }
 
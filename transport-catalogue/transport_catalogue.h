@@ -2,11 +2,13 @@
 
 #include "domain.h"
 #include "geo.h"
+#include "ranges.h"
+#include "string_pool.h"
 
 #include <string>
-#include <deque>
+#include <string_view>
 #include <unordered_map>
-#include <set>
+#include <vector>
 
 namespace transport_catalogue {
 
@@ -28,47 +30,104 @@ struct PairHash {
 
 } // namespace detail
 
+// Заранее сериализованный ответ на запрос Bus или Stop:
+// JSON-текст до и после значения request_id (см. json::Fragment)
+struct StatResponse {
+    std::string prefix;
+    std::string suffix;
+};
+
+// Остановки и автобусы хранятся в непрерывных массивах в порядке добавления,
+// остановки маршрутов всех автобусов — в одном общем массиве, на участки которого
+// ссылаются Bus::stops.
+// Номера Stop::id и Bus::id не меняются никогда. Указатели на остановки и автобусы
+// и участки Bus::stops остаются действительными, пока добавление не превышает объём,
+// зарезервированный методом Reserve. При превышении массивы перемещаются: справочник
+// обновляет свои внутренние ссылки, а полученные ранее указатели становятся недействительными.
+// Названия остановок и номера автобусов хранятся в общем пуле строк справочника
+// по одному разу: Stop::name, Bus::number и названия в других компонентах (рёбра графа,
+// вершины маршрутизатора) ссылаются на него и действительны, пока существует справочник
 class TransportCatalogue {
 public:
 
     TransportCatalogue() = default;
 
-    void AddBus(const Bus& bus);
+    // Резервирует место перед массовой загрузкой: под stops_count остановок,
+    // buses_count автобусов и route_stops_count остановок в маршрутах всех автобусов
+    // (маятниковые маршруты учитываются в обе стороны)
+    void Reserve(size_t stops_count, size_t buses_count, size_t route_stops_count);
+
+    // Добавляет автобус с маршрутом stops; поле bus.stops заполняет справочник.
+    // Номер bus.number копируется в пул, поэтому может ссылаться на временную строку
+    void AddBus(Bus bus, const std::vector<const Stop*>& stops);
 
-    void AddStop(const Stop& stop);
+    // Название stop.name копируется в пул, поэтому может ссылаться на временную строку
+    void AddStop(Stop stop);
 
-    const Bus* FindBus(const std::string& name) const;
+    const Bus* FindBus(std::string_view name) const;
 
-    const Stop* FindStop(const std::string& name) const;
+    const Stop* FindStop(std::string_view name) const;
+
+    // Строка пула, равная name (название остановки или номер автобуса),
+    // или пустая строка, если такого названия нет
+    std::string_view FindName(std::string_view name) const;
 
     std::tuple<size_t, size_t, size_t, double> GetRouteInfo(const Bus* bus) const;
 
-    void AddBusThroughStop(const Stop* stop, const std::string& bus_number);
+    // Строит индекс автобусов, проходящих через остановки. Вызывается один раз после
+    // добавления всех автобусов; AddStop и AddBus сбрасывают построенный индекс
+    void BuildBusesThroughStops();
+
+    // Автобусы, проходящие через остановку, в порядке номеров.
+    // Если индекс не построен, выбрасывает std::logic_error
+    ranges::Range<std::vector<const Bus*>::const_iterator> GetBusesThroughStop(const Stop* stop) const;
 
-    const std::set<const Bus*, detail::CompareBuses>* GetBusesThroughStop(const Stop* stop) const;
+    void AddDistanceBetweenStops(std::string_view from_stop, const size_t distance, std::string_view to_stop);
 
-    void AddDistanceBetweenStops(const std::string& from_stop, const size_t distance, const std::string& to_stop);
+    size_t GetDistanceBetweenStops(std::string_view from_stop, std::string_view to_stop) const;
 
-    size_t GetDistanceBetweenStops(const std::string& from_stop, const std::string& to_stop) const;
+    // Готовые ответы на запросы Bus и Stop, сохранённые в базе при make_base.
+    // Справочник их не пересчитывает: после изменения данных их нужно задать заново
+    void SetStatResponse(const Bus* bus, StatResponse response);
+
+    void SetStatResponse(const Stop* stop, StatResponse response);
+
+    const StatResponse* GetStatResponse(const Bus* bus) const;
+
+    const StatResponse* GetStatResponse(const Stop* stop) const;
 
     const std::unordered_map<std::string_view, const Bus*>& GetAllBuses() const;
 
     const std::unordered_map<std::string_view, const Stop*>& GetAllStops() const;
     
-    const std::deque<Bus>& GetAllRawBuses() const;
+    const std::vector<Bus>& GetAllRawBuses() const;
 
-    const std::deque<Stop>& GetAllRawStops() const;
+    const std::vector<Stop>& GetAllRawStops() const;
 
     const std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, detail::PairHash>& GetDistancesBetweenStops() const;
 
 private:
+    // Увеличивают ёмкость массивов и восстанавливают ссылки на перемещённые элементы
+    void ReserveStops(size_t capacity);
+
+    void ReserveBuses(size_t capacity);
+
+    void ReserveRouteStops(size_t capacity);
 
-    std::deque<Bus> buses_;
-    std::deque<Stop> stops_;
+    string_pool::StringPool names_;
+    std::vector<Bus> buses_;
+    std::vector<Stop> stops_;
+    std::vector<const Stop*> route_stops_;
     std::unordered_map<std::string_view, const Bus*> index_buses_;
     std::unordered_map<std::string_view, const Stop*> index_stops_;
-    std::unordered_map<const Stop*, std::set<const Bus*, detail::CompareBuses>> index_buses_through_stop_;
+    // Автобусы остановки с номером id лежат в buses_through_stops_
+    // с позиции buses_through_stop_offsets_[id] до buses_through_stop_offsets_[id + 1]
+    std::vector<size_t> buses_through_stop_offsets_;
+    std::vector<const Bus*> buses_through_stops_;
     std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, detail::PairHash> index_distances_between_stops_;
+    // Ответы по номерам Bus::id и Stop::id
+    std::unordered_map<size_t, StatResponse> bus_responses_;
+    std::unordered_map<size_t, StatResponse> stop_responses_;
 };
 
 } // namespace transport_catalogue
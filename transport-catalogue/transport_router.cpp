@@ -1,4 +1,5 @@
 #include "transport_router.h"
+#include "stats.h"
 
 #include <iostream>
 #include <unordered_map>
@@ -16,91 +17,233 @@ const RoutingSettings& Router::GetRoutingSettings() const {
 }
 
 void Router::BuildGraph(const TransportCatalogue& db) {
+    graph_loader_ = nullptr;
 
     const std::unordered_map<std::string_view, const Bus*>& all_buses = db.GetAllBuses();
     const std::unordered_map<std::string_view, const Stop*>& all_stops = db.GetAllStops();
     
     graph::DirectedWeightedGraph<double> graph(all_stops.size() * 2);
+    AddStopEdges(graph, all_stops);
 
-    std::map<std::string, graph::VertexId> stop_ids;
+    for (const auto& bus : all_buses) {
+        AddBusEdges(graph, *bus.second, db);
+    }
+    graph_ = std::move(graph);
+}
+
+void Router::UpdateGraph(const TransportCatalogue& db, const Router& old_router,
+                         const std::unordered_set<std::string_view>& rebuilt_buses) {
+    graph_loader_ = nullptr;
+
+    const std::unordered_map<std::string_view, const Bus*>& all_buses = db.GetAllBuses();
+    const std::unordered_map<std::string_view, const Stop*>& all_stops = db.GetAllStops();
+
+    graph::DirectedWeightedGraph<double> graph(all_stops.size() * 2);
+    AddStopEdges(graph, all_stops);
+
+    // Вершина ожидания остановки имеет чётный номер, следующая за ней — вершина посадки,
+    // поэтому по номеру любой из двух вершин восстанавливается название остановки
+    const graph::DirectedWeightedGraph<double>& old_graph = old_router.GetGraph();
+    std::vector<std::string_view> old_stop_names(old_graph.GetVertexCount() / 2);
+    for (const auto& [name, id] : old_router.GetStopIds()) {
+        old_stop_names[id / 2] = name;
+    }
+
+    // Рёбра автобусов, которых не коснулись изменения, переносятся из старого графа
+    // с перенумерацией вершин, остальные строятся заново. Названия старого графа ссылаются
+    // на пул старого справочника, поэтому заменяются номерами автобусов нового
+    for (graph::EdgeId edge_id = 0; edge_id < old_graph.GetEdgeCount(); ++edge_id) {
+        const graph::Edge<double>& edge = old_graph.GetEdge(edge_id);
+        if (edge.span_count == 0 || rebuilt_buses.count(edge.name)) {
+            continue;
+        }
+        const Bus* bus = db.FindBus(edge.name);
+        if (bus == nullptr) {
+            continue;
+        }
+        graph.AddEdge({bus->number, edge.span_count, stop_ids_.at(old_stop_names[edge.from / 2]) + 1,
+                       stop_ids_.at(old_stop_names[edge.to / 2]), edge.weight});
+    }
+
+    for (const auto& bus : all_buses) {
+        if (rebuilt_buses.count(bus.second->number)) {
+            AddBusEdges(graph, *bus.second, db);
+        }
+    }
+    graph_ = std::move(graph);
+}
+
+void Router::AddStopEdges(graph::DirectedWeightedGraph<double>& graph,
+                          const std::unordered_map<std::string_view, const Stop*>& all_stops) {
+    std::map<std::string_view, graph::VertexId> stop_ids;
     graph::VertexId vertex_id = 0;
-    
+
     for (const auto& stop : all_stops) {
         stop_ids[stop.second->name] = vertex_id;
         graph.AddEdge({stop.second->name, 0, vertex_id, ++vertex_id, static_cast<double>(routing_settings_.bus_wait_time)});
         ++vertex_id;
     }
     stop_ids_ = move(stop_ids);
+}
 
-    for (const auto& bus : all_buses) {
-        const auto& bus_ptr = bus.second;
-        const std::vector<const Stop*>& stops = bus_ptr->stops;
-        size_t stops_count = stops.size();
-        
-        for (size_t i = 0; i < stops_count; ++i) {
-            for (size_t j = i + 1; j < stops_count; ++j) {
-                const Stop* stop_from = stops[i];
-                const Stop* stop_to = stops[j];
-                int length = 0;
-                for (size_t k = i + 1; k <= j; ++k) {
-                    length += db.GetDistanceBetweenStops(stops[k - 1]->name, stops[k]->name);
-                }
-                graph.AddEdge({bus_ptr->number, j - i, stop_ids_.at(stop_from->name) + 1, stop_ids_.at(stop_to->name),
-                                length / (routing_settings_.bus_velocity * (100.0 / 6.0))});
-                if (bus_ptr->route_type == RouteType::Pendulum && stop_to == bus_ptr->final_stop && j == stops_count / 2) {
-                    break;
-                } 
+void Router::AddBusEdges(graph::DirectedWeightedGraph<double>& graph, const Bus& bus, const TransportCatalogue& db) const {
+    const StopSpan& stops = bus.stops;
+    size_t stops_count = stops.size();
+
+    for (size_t i = 0; i < stops_count; ++i) {
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            const Stop* stop_from = stops[i];
+            const Stop* stop_to = stops[j];
+            int length = 0;
+            for (size_t k = i + 1; k <= j; ++k) {
+                length += db.GetDistanceBetweenStops(stops[k - 1]->name, stops[k]->name);
+            }
+            graph.AddEdge({bus.number, j - i, stop_ids_.at(stop_from->name) + 1, stop_ids_.at(stop_to->name),
+                            length / (routing_settings_.bus_velocity * (100.0 / 6.0))});
+            if (bus.route_type == RouteType::Pendulum && stop_to == bus.final_stop && j == stops_count / 2) {
+                break;
             }
         }
     }
-    graph_ = std::move(graph);
+}
+
+void Router::SetGraphLoader(GraphLoader loader) {
+    graph_loader_ = std::move(loader);
+}
+
+void Router::LoadGraph() const {
+    std::call_once(graph_flag_, [this] {
+        if (graph_loader_) {
+            GraphData data = graph_loader_();
+            graph_ = std::move(data.graph);
+            stop_ids_ = std::move(data.stop_ids);
+            graph_loader_ = nullptr;
+        }
+    });
+}
+
+void Router::InitializeRouter() {
+    LoadGraph();
+    delete router_ptr_;
     router_ptr_ = new graph::Router<double>(graph_);
 }
 
+void Router::UpdateEdgeWeight(graph::EdgeId edge_id, double weight) {
+    LoadGraph();
+    const double old_weight = graph_.GetEdge(edge_id).weight;
+    graph_.SetEdgeWeight(edge_id, weight);
+    if (router_ptr_ != nullptr) {
+        router_ptr_->UpdateEdgeWeight(edge_id, old_weight);
+    }
+}
+
+void Router::UpdateRoutingSettings(RoutingSettings settings) {
+    LoadGraph();
+    const double velocity_ratio = routing_settings_.bus_velocity / settings.bus_velocity;
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const graph::Edge<double>& edge = graph_.GetEdge(edge_id);
+        if (edge.span_count == 0) {
+            graph_.SetEdgeWeight(edge_id, static_cast<double>(settings.bus_wait_time));
+        } else {
+            graph_.SetEdgeWeight(edge_id, edge.weight * velocity_ratio);
+        }
+    }
+    routing_settings_ = std::move(settings);
+    // Изменились веса всех рёбер, поэтому таблица строится заново
+    if (router_ptr_ != nullptr) {
+        router_ptr_->Rebuild();
+    }
+}
+
 void Router::SetGraph(graph::DirectedWeightedGraph<double>&& graph) {
+    graph_loader_ = nullptr;
     graph_ = std::move(graph);
-    router_ptr_ = new graph::Router<double>(graph_);
 }
 
 const graph::DirectedWeightedGraph<double>& Router::GetGraph() const {
+    LoadGraph();
     return graph_;
 }
 
-void Router::SetStopIds(std::map<std::string, graph::VertexId>&& stop_ids) {
+void Router::SetStopIds(std::map<std::string_view, graph::VertexId>&& stop_ids) {
+    graph_loader_ = nullptr;
     stop_ids_ = std::move(stop_ids);
 }
 
-const std::map<std::string, graph::VertexId>& Router::GetStopIds() const {
+const std::map<std::string_view, graph::VertexId>& Router::GetStopIds() const {
+    LoadGraph();
     return stop_ids_;
 }
 
 std::optional<graph::Router<double>::RouteInfo> Router::GetRouteInfo(const Stop* from_stop, const Stop* to_stop) const {
+    std::call_once(router_flag_, [this] {
+        if (router_ptr_ == nullptr) {
+            stats::ScopedStage stage("router_init"sv);
+            LoadGraph();
+            router_ptr_ = new graph::Router<double>(graph_);
+        }
+    });
     return router_ptr_->BuildRoute(stop_ids_.at(from_stop->name), stop_ids_.at(to_stop->name));
 }
 
 json::Array Router::GetEdgesInfo(const std::vector<graph::EdgeId>& edges) const {
+    LoadGraph();
     json::Array items_array;
     items_array.reserve(edges.size());
     for (auto& edge_id : edges) {
         const graph::Edge<double>& edge = graph_.GetEdge(edge_id);
         if (edge.span_count == 0) {
-            items_array.emplace_back(json::Node(json::Dict{
+            items_array.emplace_back(json::Dict{
                 {{"stop_name"s},{static_cast<std::string>(edge.name)}},
                 {{"time"s},{edge.weight}},
                 {{"type"s},{"Wait"s}}
-            }));
+            });
         } else {
-            items_array.emplace_back(json::Node(json::Dict{
+            items_array.emplace_back(json::Dict{
                 {{"bus"s},{static_cast<std::string>(edge.name)}},
                 {{"span_count"s},{static_cast<int>(edge.span_count)}},
                 {{"time"s},{edge.weight}},
                 {{"type"s},{"Bus"s}}
-            }));
+            });
         }
     }
     return items_array;
 }
 
+std::optional<TimetableRouter::RouteInfo> Router::GetTimetableRouteInfo(const Stop* from_stop, const Stop* to_stop,
+                                                                        double departure_time) const {
+    std::call_once(timetable_router_flag_, [this] {
+        timetable_router_ = std::make_unique<TimetableRouter>(db_, routing_settings_.bus_velocity);
+    });
+    return timetable_router_->BuildRoute(from_stop, to_stop, departure_time);
+}
+
+std::vector<RaptorRouter::Journey> Router::GetRouteOptions(const Stop* from_stop, const Stop* to_stop) const {
+    std::call_once(raptor_router_flag_, [this] {
+        raptor_router_ = std::make_unique<RaptorRouter>(db_, routing_settings_.bus_wait_time, routing_settings_.bus_velocity);
+    });
+    return raptor_router_->BuildRoutes(from_stop, to_stop);
+}
+
+json::Array Router::GetLegsInfo(const std::vector<RouteLeg>& legs) const {
+    json::Array items_array;
+    items_array.reserve(legs.size() * 2);
+    for (const auto& leg : legs) {
+        items_array.emplace_back(json::Dict{
+            {{"stop_name"s},{std::string(leg.from_stop->name)}},
+            {{"time"s},{leg.wait_time}},
+            {{"type"s},{"Wait"s}}
+        });
+        items_array.emplace_back(json::Dict{
+            {{"bus"s},{std::string(leg.bus->number)}},
+            {{"span_count"s},{static_cast<int>(leg.span_count)}},
+            {{"time"s},{leg.ride_time}},
+            {{"type"s},{"Bus"s}}
+        });
+    }
+    return items_array;
+}
+
 void Router::PrintRoutingSettings() const {
     std::cout << "bus_wait_time = "s << routing_settings_.bus_wait_time << std::endl;
     std::cout << "bus_velocity = "s << routing_settings_.bus_velocity << std::endl;
@@ -3,9 +3,16 @@
 #include "domain.h"
 #include "json.h"
 #include "router.h"
+#include "raptor_router.h"
+#include "timetable_router.h"
 #include "transport_catalogue.h"
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 
 namespace router {
 
@@ -18,6 +25,14 @@ struct RoutingSettings {
 
 class Router {
 public:
+    // Граф и идентификаторы вершин остановок, восстанавливаемые из файла базы
+    struct GraphData {
+        graph::DirectedWeightedGraph<double> graph;
+        std::map<std::string_view, graph::VertexId> stop_ids;
+    };
+
+    using GraphLoader = std::function<GraphData()>;
+
     Router(const TransportCatalogue& db)
         : db_(db) {
     }
@@ -27,18 +42,56 @@ public:
     const RoutingSettings& GetRoutingSettings() const;
 
     void BuildGraph(const TransportCatalogue& db);
+
+    // Строит граф для обновлённой базы db, перенося из графа old_router рёбра автобусов,
+    // которых не коснулись изменения. Рёбра автобусов из rebuilt_buses строятся заново
+    void UpdateGraph(const TransportCatalogue& db, const Router& old_router,
+                     const std::unordered_set<std::string_view>& rebuilt_buses);
+
+    // Откладывает восстановление графа до первого обращения к нему:
+    // loader вызывается не более одного раза, в том числе при одновременных
+    // запросах из нескольких потоков. SetGraph, SetStopIds и BuildGraph отменяют загрузку
+    void SetGraphLoader(GraphLoader loader);
+
+    // Вычисляет таблицу кратчайших путей между всеми вершинами графа.
+    // Нужна только для ответов на запросы Route, поэтому без явного вызова
+    // строится при первом таком запросе
+    void InitializeRouter();
+
+    // Меняет вес ребра, например чтобы учесть задержку на перегоне.
+    // Таблица кратчайших путей, если она уже построена, восстанавливается
+    // только для затронутых вершин
+    void UpdateEdgeWeight(graph::EdgeId edge_id, double weight);
+
+    // Меняет параметры маршрутизации без перестроения графа: веса рёбер ожидания
+    // заменяются новым временем ожидания, веса рёбер поездки пересчитываются
+    // пропорционально изменению скорости (вместе с ранее заданными задержками)
+    void UpdateRoutingSettings(RoutingSettings settings);
     
     void SetGraph(graph::DirectedWeightedGraph<double>&& graph);
 
     const graph::DirectedWeightedGraph<double>& GetGraph() const;
 
-    void SetStopIds(std::map<std::string, graph::VertexId>&& stop_ids);
+    // Названия остановок — строки из пула названий справочника
+    void SetStopIds(std::map<std::string_view, graph::VertexId>&& stop_ids);
 
-    const std::map<std::string, graph::VertexId>& GetStopIds() const;
+    const std::map<std::string_view, graph::VertexId>& GetStopIds() const;
 
     std::optional<graph::Router<double>::RouteInfo> GetRouteInfo(const Stop* from_stop, const Stop* to_stop) const;
 
     json::Array GetEdgesInfo(const std::vector<graph::EdgeId>& edges) const;
+
+    // Маршрут с учётом расписаний автобусов при отправлении в момент departure_time
+    // (в минутах от начала суток). Маршрутизатор по расписанию строится
+    // при первом таком запросе
+    std::optional<TimetableRouter::RouteInfo> GetTimetableRouteInfo(const Stop* from_stop, const Stop* to_stop,
+                                                                    double departure_time) const;
+
+    // Парето-оптимальные по времени в пути и числу пересадок маршруты.
+    // Маршрутизатор RAPTOR строится при первом таком запросе
+    std::vector<RaptorRouter::Journey> GetRouteOptions(const Stop* from_stop, const Stop* to_stop) const;
+
+    json::Array GetLegsInfo(const std::vector<RouteLeg>& legs) const;
     
     void PrintRoutingSettings() const;
 
@@ -47,11 +100,25 @@ public:
     }
 
 private:
+    void LoadGraph() const;
+
+    void AddStopEdges(graph::DirectedWeightedGraph<double>& graph,
+                      const std::unordered_map<std::string_view, const Stop*>& all_stops);
+
+    void AddBusEdges(graph::DirectedWeightedGraph<double>& graph, const Bus& bus, const TransportCatalogue& db) const;
+
     const TransportCatalogue& db_;
     RoutingSettings routing_settings_;
-    graph::DirectedWeightedGraph<double> graph_;
-    graph::Router<double>* router_ptr_ = nullptr;
-    std::map<std::string, graph::VertexId> stop_ids_;
+    mutable std::once_flag graph_flag_;
+    mutable GraphLoader graph_loader_;
+    mutable graph::DirectedWeightedGraph<double> graph_;
+    mutable std::map<std::string_view, graph::VertexId> stop_ids_;
+    mutable std::once_flag router_flag_;
+    mutable graph::Router<double>* router_ptr_ = nullptr;
+    mutable std::once_flag timetable_router_flag_;
+    mutable std::unique_ptr<TimetableRouter> timetable_router_;
+    mutable std::once_flag raptor_router_flag_;
+    mutable std::unique_ptr<RaptorRouter> raptor_router_;
 };
 
 } // namespace router